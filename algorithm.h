@@ -0,0 +1,829 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Standard templates library. Freestanding implementation.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Algorithms
+
+#ifndef _RTL_ALGORITHM_H_
+#define _RTL_ALGORITHM_H_
+
+#include <bitops.h>
+#include <iterator.h>
+#include <iterator_traits.h>
+#include <utility.h>
+#include <vector.h>
+
+namespace rtl
+{
+	// Default comparison
+	template<class T>
+	struct less
+	{
+		bool operator()(const T& a, const T& b) const { return a < b; }
+	};
+
+	// ----- Copy and move -----
+	template<class InputIterator, class OutputIterator>
+	OutputIterator copy(InputIterator first, InputIterator last, OutputIterator result)
+	{
+		for(; first != last; ++first, ++result)
+			*result = *first;
+		return result;
+	}
+
+	// Appending to a vector inserts the whole range at once, so the vector grows only once for forward ranges
+	template<class InputIterator, class T, class A>
+	back_insert_iterator<vector<T,A>> copy(InputIterator first, InputIterator last, back_insert_iterator<vector<T,A>> result)
+	{
+		vector<T,A>& v = result.container();
+		v.insert(v.end(), first, last);
+		return result;
+	}
+
+	template<class InputIterator, class OutputIterator>
+	inline OutputIterator move(InputIterator first, InputIterator last, OutputIterator result)
+	{
+		return rtl::copy(rtl::make_move_iterator(first), rtl::make_move_iterator(last), result);
+	}
+
+	// ----- Binary search -----
+	// Both searches are branchless: the loop runs a fixed number of iterations for a given length, and the comparison
+	// result only selects the next base, which compilers turn into a conditional move.
+	template<class RandomAccessIterator, class T, class Compare>
+	RandomAccessIterator lower_bound(RandomAccessIterator first, RandomAccessIterator last, const T& value, Compare comp)
+	{
+		typename iterator_traits<RandomAccessIterator>::difference_type len = last - first;
+		if(0 == len)
+			return first;
+		while(len > 1)
+		{
+			typename iterator_traits<RandomAccessIterator>::difference_type half = len / 2;
+			first = comp(first[half], value) ? first + half : first;
+			len -= half;
+		}
+		return comp(*first, value) ? first + 1 : first;
+	}
+
+	template<class RandomAccessIterator, class T>
+	RandomAccessIterator lower_bound(RandomAccessIterator first, RandomAccessIterator last, const T& value)
+	{
+		return rtl::lower_bound(first, last, value, less<T>());
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class RandomAccessIterator, class T, class Compare>
+	RandomAccessIterator upper_bound(RandomAccessIterator first, RandomAccessIterator last, const T& value, Compare comp)
+	{
+		typename iterator_traits<RandomAccessIterator>::difference_type len = last - first;
+		if(0 == len)
+			return first;
+		while(len > 1)
+		{
+			typename iterator_traits<RandomAccessIterator>::difference_type half = len / 2;
+			first = comp(value, first[half]) ? first : first + half;
+			len -= half;
+		}
+		return comp(value, *first) ? first : first + 1;
+	}
+
+	template<class RandomAccessIterator, class T>
+	RandomAccessIterator upper_bound(RandomAccessIterator first, RandomAccessIterator last, const T& value)
+	{
+		return rtl::upper_bound(first, last, value, less<T>());
+	}
+
+	// ----- Removal -----
+	// Unique: keeps the first element of every run of equivalent elements. Returns the new end of the range.
+	template<class ForwardIterator, class BinaryPredicate>
+	ForwardIterator unique(ForwardIterator first, ForwardIterator last, BinaryPredicate equal)
+	{
+		if(first == last)
+			return last;
+		ForwardIterator result = first;
+		while(++first != last)
+		{
+			if(!equal(*result, *first))
+			{
+				if(++result != first)
+					*result = *first;
+			}
+		}
+		return ++result;
+	}
+
+	// ----- Heap operations -----
+	// Moves *(first+hole) down the max heap [first, first+len) until both children compare less or equal to it
+	template<class RandomAccessIterator, class Distance, class Compare>
+	void sift_down(RandomAccessIterator first, Distance hole, Distance len, Compare comp)
+	{
+		typename iterator_traits<RandomAccessIterator>::value_type value = first[hole];
+		Distance child = 2 * hole + 1;
+		while(child < len)
+		{
+			if(child + 1 < len && comp(first[child], first[child + 1]))
+				++child;
+			if(!comp(value, first[child]))
+				break;
+			first[hole] = first[child];
+			hole = child;
+			child = 2 * hole + 1;
+		}
+		first[hole] = value;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class RandomAccessIterator, class Compare>
+	void make_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp)
+	{
+		typename iterator_traits<RandomAccessIterator>::difference_type len = last - first;
+		for(typename iterator_traits<RandomAccessIterator>::difference_type i = len / 2; i > 0; --i)
+			sift_down(first, i - 1, len, comp);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class RandomAccessIterator, class Compare>
+	void sort_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp)
+	{
+		typedef typename iterator_traits<RandomAccessIterator>::difference_type Distance;
+		Distance len = last - first;
+		while(len > 1)
+		{
+			--len;
+			rtl::swap(first[0], first[len]);
+			sift_down(first, Distance(0), len, comp);
+		}
+	}
+
+	// ----- Sorting -----
+	// Heap sort: in place and O(n log n) in the worst case
+	template<class RandomAccessIterator, class Compare>
+	void heap_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp)
+	{
+		rtl::make_heap(first, last, comp);
+		rtl::sort_heap(first, last, comp);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class ForwardIterator1, class ForwardIterator2>
+	inline void iter_swap(ForwardIterator1 a, ForwardIterator2 b)
+	{
+		rtl::swap(*a, *b);
+	}
+
+	namespace detail
+	{
+		// Ranges shorter than this are insertion sorted
+		const int InsertionSortThreshold = 24;
+		// Ranges longer than this take their pivot from a pseudo median of nine
+		const int NintherThreshold = 128;
+		// Elements classified at a time by the branchless partition. Offsets within a block must fit in an unsigned char.
+		const int PartitionBlockSize = 64;
+		// Length of the runs stable_sort insertion sorts before merging
+		const int MergeRunLength = 32;
+
+		//--------------------------------------------------------------------------------------------------------------
+		// Stable. Quadratic, but the fastest option for tiny or almost sorted ranges.
+		template<class RandomAccessIterator, class Compare>
+		void insertion_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp)
+		{
+			if(first == last)
+				return;
+			for(RandomAccessIterator i = first + 1; i != last; ++i)
+			{
+				if(comp(*i, *(i - 1)))
+				{
+					typename iterator_traits<RandomAccessIterator>::value_type value = *i;
+					RandomAccessIterator hole = i;
+					do
+					{
+						*hole = *(hole - 1);
+						--hole;
+					}
+					while(hole != first && comp(value, *(hole - 1)));
+					*hole = value;
+				}
+			}
+		}
+
+		//--------------------------------------------------------------------------------------------------------------
+		// Leaves *a <= *b <= *c
+		template<class RandomAccessIterator, class Compare>
+		inline void sort3(RandomAccessIterator a, RandomAccessIterator b, RandomAccessIterator c, Compare comp)
+		{
+			if(comp(*b, *a))
+				rtl::iter_swap(a, b);
+			if(comp(*c, *b))
+				rtl::iter_swap(b, c);
+			if(comp(*b, *a))
+				rtl::iter_swap(a, b);
+		}
+
+		//--------------------------------------------------------------------------------------------------------------
+		// Exchanges the misplaced elements recorded by partition_right_branchless. When both blocks have the same number
+		// of them, plain swaps are needed to keep descending inputs linear. Otherwise a rotation saves a third of the moves.
+		template<class RandomAccessIterator>
+		void swap_offsets(RandomAccessIterator first, RandomAccessIterator last, const unsigned char* offsetsL,
+			const unsigned char* offsetsR, int num, bool useSwaps)
+		{
+			if(useSwaps)
+			{
+				for(int i = 0; i < num; ++i)
+					rtl::iter_swap(first + offsetsL[i], last - offsetsR[i]);
+			}
+			else if(num > 0)
+			{
+				RandomAccessIterator l = first + offsetsL[0];
+				RandomAccessIterator r = last - offsetsR[0];
+				typename iterator_traits<RandomAccessIterator>::value_type tmp = *l;
+				*l = *r;
+				for(int i = 1; i < num; ++i)
+				{
+					l = first + offsetsL[i];
+					*r = *l;
+					r = last - offsetsR[i];
+					*l = *r;
+				}
+				*r = tmp;
+			}
+		}
+
+		//--------------------------------------------------------------------------------------------------------------
+		// Partitions [begin, end) around *begin into elements less than it and elements not less than it, and returns
+		// the final position of the pivot. Requires an element not less than the pivot after it (median selection does
+		// that). Elements are classified a block at a time into offset buffers, adding comparison results instead of
+		// branching on them, so the cost of the partition doesn't depend on how predictable the comparisons are.
+		// Derived from BlockQuicksort (Edelkamp & Weiss) as tuned in pdqsort (Peters).
+		template<class RandomAccessIterator, class Compare>
+		RandomAccessIterator partition_right_branchless(RandomAccessIterator begin, RandomAccessIterator end, Compare comp)
+		{
+			typedef typename iterator_traits<RandomAccessIterator>::difference_type	Distance;
+			typename iterator_traits<RandomAccessIterator>::value_type pivot = *begin;
+			RandomAccessIterator first = begin;
+			RandomAccessIterator last = end;
+
+			// Skip the prefix and suffix that are already in place. The search from the right only needs a guard when
+			// nothing before first is known to be less than the pivot.
+			while(comp(*++first, pivot))
+				;
+			if(first - 1 == begin)
+				while(first < last && !comp(*--last, pivot))
+					;
+			else
+				while(!comp(*--last, pivot))
+					;
+
+			if(first < last)
+			{
+				rtl::iter_swap(first, last);
+				++first;
+
+				unsigned char offsetsL[PartitionBlockSize];
+				unsigned char offsetsR[PartitionBlockSize];
+				int numL = 0, numR = 0;
+				int startL = 0, startR = 0;
+				// Whole blocks on both sides
+				while(last - first > 2 * PartitionBlockSize)
+				{
+					if(0 == numL)
+					{
+						startL = 0;
+						RandomAccessIterator it = first;
+						for(int i = 0; i < PartitionBlockSize; ++it)
+						{
+							offsetsL[numL] = (unsigned char)(i++);
+							numL += !comp(*it, pivot);
+						}
+					}
+					if(0 == numR)
+					{
+						startR = 0;
+						RandomAccessIterator it = last;
+						for(int i = 0; i < PartitionBlockSize;)
+						{
+							offsetsR[numR] = (unsigned char)(++i);
+							numR += comp(*--it, pivot);
+						}
+					}
+					int num = numL < numR ? numL : numR;
+					swap_offsets(first, last, offsetsL + startL, offsetsR + startR, num, numL == numR);
+					numL -= num;
+					numR -= num;
+					startL += num;
+					startR += num;
+					if(0 == numL)
+						first += PartitionBlockSize;
+					if(0 == numR)
+						last -= PartitionBlockSize;
+				}
+
+				// What is left, fewer than two blocks. A side with pending offsets keeps its block.
+				Distance sizeL = 0, sizeR = 0;
+				Distance unknown = (last - first) - ((numR || numL) ? PartitionBlockSize : 0);
+				if(numR)
+				{
+					sizeL = unknown;
+					sizeR = PartitionBlockSize;
+				}
+				else if(numL)
+				{
+					sizeL = PartitionBlockSize;
+					sizeR = unknown;
+				}
+				else
+				{
+					sizeL = unknown / 2;
+					sizeR = unknown - sizeL;
+				}
+				if(unknown && 0 == numL)
+				{
+					startL = 0;
+					RandomAccessIterator it = first;
+					for(int i = 0; i < sizeL; ++it)
+					{
+						offsetsL[numL] = (unsigned char)(i++);
+						numL += !comp(*it, pivot);
+					}
+				}
+				if(unknown && 0 == numR)
+				{
+					startR = 0;
+					RandomAccessIterator it = last;
+					for(int i = 0; i < sizeR;)
+					{
+						offsetsR[numR] = (unsigned char)(++i);
+						numR += comp(*--it, pivot);
+					}
+				}
+				int num = numL < numR ? numL : numR;
+				swap_offsets(first, last, offsetsL + startL, offsetsR + startR, num, numL == numR);
+				numL -= num;
+				numR -= num;
+				startL += num;
+				startR += num;
+				if(0 == numL)
+					first += sizeL;
+				if(0 == numR)
+					last -= sizeR;
+
+				// At most one side has misplaced elements left. Move them across the boundary.
+				if(numL)
+				{
+					while(numL--)
+						rtl::iter_swap(first + offsetsL[startL + numL], --last);
+					first = last;
+				}
+				if(numR)
+				{
+					while(numR--)
+					{
+						rtl::iter_swap(last - offsetsR[startR + numR], first);
+						++first;
+					}
+					last = first;
+				}
+			}
+
+			// Put the pivot in place
+			RandomAccessIterator pivotPos = first - 1;
+			*begin = *pivotPos;
+			*pivotPos = pivot;
+			return pivotPos;
+		}
+
+		//--------------------------------------------------------------------------------------------------------------
+		// Partitions [begin, end) around *begin into elements not greater than it and elements greater than it. Used
+		// when the pivot equals the element before the range: everything on the left is then equal to the pivot.
+		template<class RandomAccessIterator, class Compare>
+		RandomAccessIterator partition_left(RandomAccessIterator begin, RandomAccessIterator end, Compare comp)
+		{
+			typename iterator_traits<RandomAccessIterator>::value_type pivot = *begin;
+			RandomAccessIterator first = begin;
+			RandomAccessIterator last = end;
+
+			while(comp(pivot, *--last))
+				;
+			if(last + 1 == end)
+				while(first < last && !comp(pivot, *++first))
+					;
+			else
+				while(!comp(pivot, *++first))
+					;
+
+			while(first < last)
+			{
+				rtl::iter_swap(first, last);
+				while(comp(pivot, *--last))
+					;
+				while(!comp(pivot, *++first))
+					;
+			}
+
+			RandomAccessIterator pivotPos = last;
+			*begin = *pivotPos;
+			*pivotPos = pivot;
+			return pivotPos;
+		}
+
+		//--------------------------------------------------------------------------------------------------------------
+		// Pattern defeating introsort loop. Recurses on the left part and iterates on the right one. leftmost tells
+		// whether the range has no predecessor, which otherwise is known to be no greater than any of its elements.
+		template<class RandomAccessIterator, class Compare>
+		void introsort_loop(RandomAccessIterator first, RandomAccessIterator last, Compare comp, int badAllowed,
+			bool leftmost)
+		{
+			typedef typename iterator_traits<RandomAccessIterator>::difference_type	Distance;
+			for(;;)
+			{
+				Distance size = last - first;
+				if(size < InsertionSortThreshold)
+				{
+					insertion_sort(first, last, comp);
+					return;
+				}
+
+				// Move the pivot to first, leaving an element not less than it at the back
+				Distance half = size / 2;
+				if(size > NintherThreshold)
+				{
+					sort3(first, first + half, last - 1, comp);
+					sort3(first + 1, first + (half - 1), last - 2, comp);
+					sort3(first + 2, first + (half + 1), last - 3, comp);
+					sort3(first + (half - 1), first + half, first + (half + 1), comp);
+					rtl::iter_swap(first, first + half);
+				}
+				else
+					sort3(first + half, first, last - 1, comp);
+
+				// A pivot equal to the predecessor means lots of equal elements: group them on the left, where they
+				// are already sorted, and only keep sorting the greater ones.
+				if(!leftmost && !comp(*(first - 1), *first))
+				{
+					first = partition_left(first, last, comp) + 1;
+					continue;
+				}
+
+				RandomAccessIterator pivot = partition_right_branchless(first, last, comp);
+				// Too many unbalanced partitions mean an adversarial input: fall back to a guaranteed O(n log n)
+				Distance leftSize = pivot - first;
+				Distance rightSize = last - (pivot + 1);
+				if((leftSize < size / 8 || rightSize < size / 8) && 0 == --badAllowed)
+				{
+					rtl::heap_sort(first, last, comp);
+					return;
+				}
+
+				introsort_loop(first, pivot, comp, badAllowed, leftmost);
+				first = pivot + 1;
+				leftmost = false;
+			}
+		}
+	}	// namespace detail
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Introsort with branchless block partitioning. O(n log n) in the worst case, not stable.
+	template<class RandomAccessIterator, class Compare>
+	void sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp)
+	{
+		if(last - first < 2)
+			return;
+		detail::introsort_loop(first, last, comp, int(highest_bit(last - first)), true);
+	}
+
+	template<class RandomAccessIterator>
+	void sort(RandomAccessIterator first, RandomAccessIterator last)
+	{
+		rtl::sort(first, last, less<typename iterator_traits<RandomAccessIterator>::value_type>());
+	}
+
+	// ----- Stable sorting -----
+	namespace detail
+	{
+		// Stable merge of two sorted ranges into a third one
+		template<class InputIterator, class OutputIterator, class Compare>
+		void merge_into(InputIterator first1, InputIterator last1, InputIterator first2, InputIterator last2,
+			OutputIterator result, Compare comp)
+		{
+			while(first1 != last1 && first2 != last2)
+			{
+				if(comp(*first2, *first1))
+					*result++ = *first2++;
+				else
+					*result++ = *first1++;
+			}
+			while(first1 != last1)
+				*result++ = *first1++;
+			while(first2 != last2)
+				*result++ = *first2++;
+		}
+
+		// Merges every pair of adjacent sorted runs of length _width from src into dst
+		template<class InputIterator, class OutputIterator, class Distance, class Compare>
+		void merge_pass(InputIterator src, OutputIterator dst, Distance n, Distance width, Compare comp)
+		{
+			for(Distance low = 0; low < n; low += 2 * width)
+			{
+				Distance mid = low + width < n ? low + width : n;
+				Distance high = low + 2 * width < n ? low + 2 * width : n;
+				merge_into(src + low, src + mid, src + mid, src + high, dst + low, comp);
+			}
+		}
+	}	// namespace detail
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Bottom up merge sort. Stable and O(n log n). Merges ping pong between the range and scratch, which is grown to the
+	// size of the range if needed and can be reused across calls to avoid allocating.
+	template<class RandomAccessIterator, class scratchAllocT, class Compare>
+	void stable_sort(RandomAccessIterator first, RandomAccessIterator last,
+		vector<typename iterator_traits<RandomAccessIterator>::value_type, scratchAllocT>& scratch, Compare comp)
+	{
+		typedef typename iterator_traits<RandomAccessIterator>::difference_type	Distance;
+		Distance n = last - first;
+		if(n < 2)
+			return;
+		for(Distance low = 0; low < n; low += detail::MergeRunLength)
+			detail::insertion_sort(first + low, first + (low + detail::MergeRunLength < n ? low + detail::MergeRunLength : n), comp);
+		if(n <= detail::MergeRunLength)
+			return;
+
+		if(scratch.size() < size_t(n))
+			scratch.resize(n);
+		bool inScratch = false;
+		for(Distance width = detail::MergeRunLength; width < n; width *= 2)
+		{
+			if(inScratch)
+				detail::merge_pass(scratch.data(), first, n, width, comp);
+			else
+				detail::merge_pass(first, scratch.data(), n, width, comp);
+			inScratch = !inScratch;
+		}
+		if(inScratch)
+		{
+			for(Distance i = 0; i < n; ++i)
+				first[i] = scratch[i];
+		}
+	}
+
+	template<class RandomAccessIterator, class scratchAllocT>
+	void stable_sort(RandomAccessIterator first, RandomAccessIterator last,
+		vector<typename iterator_traits<RandomAccessIterator>::value_type, scratchAllocT>& scratch)
+	{
+		rtl::stable_sort(first, last, scratch, less<typename iterator_traits<RandomAccessIterator>::value_type>());
+	}
+
+	template<class RandomAccessIterator, class Compare>
+	void stable_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp)
+	{
+		vector<typename iterator_traits<RandomAccessIterator>::value_type> scratch;
+		rtl::stable_sort(first, last, scratch, comp);
+	}
+
+	template<class RandomAccessIterator>
+	void stable_sort(RandomAccessIterator first, RandomAccessIterator last)
+	{
+		vector<typename iterator_traits<RandomAccessIterator>::value_type> scratch;
+		rtl::stable_sort(first, last, scratch);
+	}
+
+	// ----- Radix sorting -----
+	// Maps a key to an unsigned integer with the same ordering, so it can be sorted a byte at a time. Specialized for
+	// every integer and floating point type.
+	template<class T> struct radix_traits;
+
+	namespace detail
+	{
+		// Raw bits of a value, without breaking aliasing rules
+		template<class To, class From>
+		inline To bit_copy(const From& _x)
+		{
+			To result;
+			const char* src = reinterpret_cast<const char*>(&_x);
+			char* dst = reinterpret_cast<char*>(&result);
+			for(unsigned i = 0; i < sizeof(To); ++i)
+				dst[i] = src[i];
+			return result;
+		}
+
+		template<class T>
+		struct unsigned_radix_traits
+		{
+			typedef T key_type;
+			static key_type key(T _x) { return _x; }
+		};
+
+		template<class T, class U>
+		struct signed_radix_traits
+		{
+			typedef U key_type;
+			static key_type key(T _x) { return U(_x) ^ (U(1) << (sizeof(U) * 8 - 1)); }
+		};
+
+		// Positive floats just need the sign bit set. Negative ones need all their bits flipped to sort in reverse.
+		template<class T, class U>
+		struct float_radix_traits
+		{
+			typedef U key_type;
+			static key_type key(T _x)
+			{
+				U bits = bit_copy<U>(_x);
+				U sign = U(1) << (sizeof(U) * 8 - 1);
+				return (bits & sign) ? ~bits : (bits | sign);
+			}
+		};
+	}	// namespace detail
+
+	template<> struct radix_traits<unsigned char>		: detail::unsigned_radix_traits<unsigned char> {};
+	template<> struct radix_traits<unsigned short>		: detail::unsigned_radix_traits<unsigned short> {};
+	template<> struct radix_traits<unsigned int>		: detail::unsigned_radix_traits<unsigned int> {};
+	template<> struct radix_traits<unsigned long>		: detail::unsigned_radix_traits<unsigned long> {};
+	template<> struct radix_traits<unsigned long long>	: detail::unsigned_radix_traits<unsigned long long> {};
+	template<> struct radix_traits<signed char>			: detail::signed_radix_traits<signed char, unsigned char> {};
+	template<> struct radix_traits<short>				: detail::signed_radix_traits<short, unsigned short> {};
+	template<> struct radix_traits<int>					: detail::signed_radix_traits<int, unsigned int> {};
+	template<> struct radix_traits<long>				: detail::signed_radix_traits<long, unsigned long> {};
+	template<> struct radix_traits<long long>			: detail::signed_radix_traits<long long, unsigned long long> {};
+	template<> struct radix_traits<char>				: detail::signed_radix_traits<char, unsigned char>
+	{
+		static key_type key(char _x) { return char(-1) < 0 ? key_type(_x) ^ 0x80 : key_type(_x); }
+	};
+	template<> struct radix_traits<float>				: detail::float_radix_traits<float, unsigned int> {};
+	template<> struct radix_traits<double>				: detail::float_radix_traits<double, unsigned long long> {};
+
+	namespace detail
+	{
+		// Uses the elements themselves as keys
+		template<class T>
+		struct identity_key
+		{
+			const T& operator()(const T& _x) const { return _x; }
+		};
+
+		template<class K>
+		inline typename radix_traits<K>::key_type radix_key(const K& _key)
+		{
+			return radix_traits<K>::key(_key);
+		}
+	}	// namespace detail
+
+	//------------------------------------------------------------------------------------------------------------------
+	// LSD radix sort of contiguous records, by the integer or floating point key keyOf returns. Stable and linear: one
+	// pass builds the histograms of every key byte, then each byte takes one scatter pass between the range and
+	// scratch. Passes where all keys share the byte are skipped, so narrow key ranges sort in fewer passes.
+	template<class T, class scratchAllocT, class KeyOf>
+	void radix_sort(T* first, T* last, vector<T, scratchAllocT>& scratch, KeyOf keyOf)
+	{
+		typedef decltype(detail::radix_key(keyOf(*first)))	keyT;
+		const unsigned KeyBytes = sizeof(keyT);
+		size_t n = size_t(last - first);
+		if(n < 2)
+			return;
+
+		size_t counts[KeyBytes][256];
+		for(unsigned b = 0; b < KeyBytes; ++b)
+			for(unsigned d = 0; d < 256; ++d)
+				counts[b][d] = 0;
+		for(size_t i = 0; i < n; ++i)
+		{
+			keyT key = detail::radix_key(keyOf(first[i]));
+			for(unsigned b = 0; b < KeyBytes; ++b)
+				++counts[b][(key >> (8 * b)) & 0xff];
+		}
+
+		if(scratch.size() < n)
+			scratch.resize(n);
+		T* src = first;
+		T* dst = scratch.data();
+		for(unsigned b = 0; b < KeyBytes; ++b)
+		{
+			size_t* count = counts[b];
+			if(n == count[(detail::radix_key(keyOf(src[0])) >> (8 * b)) & 0xff])
+				continue;	// Every key has the same byte here
+			// Counts to offsets
+			size_t offset = 0;
+			for(unsigned d = 0; d < 256; ++d)
+			{
+				size_t c = count[d];
+				count[d] = offset;
+				offset += c;
+			}
+			for(size_t i = 0; i < n; ++i)
+				dst[count[(detail::radix_key(keyOf(src[i])) >> (8 * b)) & 0xff]++] = src[i];
+			T* tmp = src;
+			src = dst;
+			dst = tmp;
+		}
+		if(src != first)
+		{
+			for(size_t i = 0; i < n; ++i)
+				first[i] = src[i];
+		}
+	}
+
+	template<class T, class scratchAllocT>
+	void radix_sort(T* first, T* last, vector<T, scratchAllocT>& scratch)
+	{
+		rtl::radix_sort(first, last, scratch, detail::identity_key<T>());
+	}
+
+	template<class T, class KeyOf>
+	void radix_sort(T* first, T* last, KeyOf keyOf)
+	{
+		vector<T> scratch;
+		rtl::radix_sort(first, last, scratch, keyOf);
+	}
+
+	template<class T>
+	void radix_sort(T* first, T* last)
+	{
+		vector<T> scratch;
+		rtl::radix_sort(first, last, scratch);
+	}
+
+	namespace detail
+	{
+		// Lexicographical comparison of fixed width keys, from byte _from on
+		template<class KeyOf>
+		struct key_bytes_less
+		{
+			KeyOf		keyOf;
+			size_t		from;
+			size_t		width;
+
+			template<class T>
+			bool operator()(const T& _a, const T& _b) const
+			{
+				const unsigned char* a = keyOf(_a);
+				const unsigned char* b = keyOf(_b);
+				for(size_t i = from; i < width; ++i)
+				{
+					if(a[i] != b[i])
+						return a[i] < b[i];
+				}
+				return false;
+			}
+		};
+
+		// In place MSD pass (American flag sort) on byte _byte, then recursion into every bucket
+		template<class T, class KeyOf>
+		void msd_radix_pass(T* first, T* last, size_t byte, size_t width, KeyOf keyOf)
+		{
+			size_t n = size_t(last - first);
+			if(n < size_t(InsertionSortThreshold))
+			{
+				key_bytes_less<KeyOf> comp = { keyOf, byte, width };
+				insertion_sort(first, last, comp);
+				return;
+			}
+			if(byte == width)
+				return;
+
+			size_t heads[256];
+			size_t tails[256];
+			for(unsigned d = 0; d < 256; ++d)
+				tails[d] = 0;
+			for(size_t i = 0; i < n; ++i)
+				++tails[keyOf(first[i])[byte]];
+			size_t offset = 0;
+			for(unsigned d = 0; d < 256; ++d)
+			{
+				heads[d] = offset;
+				offset += tails[d];
+				tails[d] = offset;
+			}
+			// Permute in place: follow each misplaced element to its bucket
+			for(unsigned d = 0; d < 256; ++d)
+			{
+				while(heads[d] < tails[d])
+				{
+					T value = first[heads[d]];
+					unsigned digit = keyOf(value)[byte];
+					while(digit != d)
+					{
+						rtl::swap(value, first[heads[digit]++]);
+						digit = keyOf(value)[byte];
+					}
+					first[heads[d]++] = value;
+				}
+			}
+			// Buckets now span [previous tail, tail)
+			size_t start = 0;
+			for(unsigned d = 0; d < 256; ++d)
+			{
+				if(tails[d] - start > 1)
+					msd_radix_pass(first + start, first + tails[d], byte + 1, width, keyOf);
+				start = tails[d];
+			}
+		}
+	}	// namespace detail
+
+	//------------------------------------------------------------------------------------------------------------------
+	// MSD radix sort of contiguous records by a fixed width key of _width bytes, compared as unsigned bytes with the
+	// most significant first. keyOf returns a pointer to the key of a record. In place and not stable. Only the bytes
+	// needed to tell keys apart are ever inspected.
+	template<class T, class KeyOf>
+	void msd_radix_sort(T* first, T* last, size_t width, KeyOf keyOf)
+	{
+		detail::msd_radix_pass(first, last, 0, width, keyOf);
+	}
+
+}	// namespace rtl
+
+#endif // _RTL_ALGORITHM_H_
@@ -0,0 +1,459 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Standard templates library. Freestanding implementation.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Bit vector
+
+#ifndef _RTL_BIT_VECTOR_H_
+#define _RTL_BIT_VECTOR_H_
+
+#include <cassert>
+#include <cstddef>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RTL_BIT_VECTOR_SSE2	// MSVC doesn't define __SSE2__. Undefined at the end of the header.
+#endif
+
+#include <bitops.h>
+#include <iterator_tags.h>
+#include <memory.h>
+#include <vector.h>
+
+namespace rtl
+{
+	namespace detail
+	{
+		// Word operations of bit_vector's bulk operators, in scalar and vector forms
+		struct bit_and
+		{
+			static unsigned long long scalar(unsigned long long a, unsigned long long b) { return a & b; }
+#if defined(__AVX2__)
+			static __m256i wide(__m256i a, __m256i b) { return _mm256_and_si256(a, b); }
+#elif defined(RTL_BIT_VECTOR_SSE2)
+			static __m128i wide(__m128i a, __m128i b) { return _mm_and_si128(a, b); }
+#endif
+		};
+
+		struct bit_or
+		{
+			static unsigned long long scalar(unsigned long long a, unsigned long long b) { return a | b; }
+#if defined(__AVX2__)
+			static __m256i wide(__m256i a, __m256i b) { return _mm256_or_si256(a, b); }
+#elif defined(RTL_BIT_VECTOR_SSE2)
+			static __m128i wide(__m128i a, __m128i b) { return _mm_or_si128(a, b); }
+#endif
+		};
+
+		struct bit_xor
+		{
+			static unsigned long long scalar(unsigned long long a, unsigned long long b) { return a ^ b; }
+#if defined(__AVX2__)
+			static __m256i wide(__m256i a, __m256i b) { return _mm256_xor_si256(a, b); }
+#elif defined(RTL_BIT_VECTOR_SSE2)
+			static __m128i wide(__m128i a, __m128i b) { return _mm_xor_si128(a, b); }
+#endif
+		};
+
+		// a & ~b
+		struct bit_and_not
+		{
+			static unsigned long long scalar(unsigned long long a, unsigned long long b) { return a & ~b; }
+#if defined(__AVX2__)
+			static __m256i wide(__m256i a, __m256i b) { return _mm256_andnot_si256(b, a); }
+#elif defined(RTL_BIT_VECTOR_SSE2)
+			static __m128i wide(__m128i a, __m128i b) { return _mm_andnot_si128(b, a); }
+#endif
+		};
+	}	// namespace detail
+
+	// Vector of bits packed in 64 bit words, taking one bit per element instead of the byte of a vector<bool>.
+	// Elements are accessed through proxy references. Whole vectors combine a word at a time: with AVX2 enabled
+	// (-mavx2, /arch:AVX2) the bulk operators process 256 bits per instruction, 128 with SSE2.
+	// Bits past size() in the last word are always zero, so counts and searches can work on whole words.
+	template<class allocatorT = rtl::allocator<bool>>
+	class bit_vector
+	{
+	public:
+		typedef unsigned long long										word_type;
+		typedef typename allocatorT::template rebind<word_type>::other	wordAllocT;
+		typedef rtl::vector<word_type, wordAllocT>						wordsT;
+
+		// Public types
+		typedef bool			value_type;
+		typedef bool			const_reference;
+		typedef	allocatorT		allocator_type;
+
+		typedef	typename rtl::allocator_traits<wordAllocT>::size_type		size_type;
+		typedef typename rtl::allocator_traits<wordAllocT>::difference_type	difference_type;
+
+		static const unsigned WordBits = 64;
+
+		// Reference to a single bit
+		class reference
+		{
+		public:
+			reference(word_type* _word, word_type _mask) : mWord(_word), mMask(_mask) {}
+
+			operator bool		() const		{ return 0 != (*mWord & mMask); }
+			bool		operator~	() const		{ return 0 == (*mWord & mMask); }
+			reference&	operator=	(bool _x)		{ *mWord = _x ? (*mWord | mMask) : (*mWord & ~mMask); return *this; }
+			reference&	operator=	(const reference& _x)	{ return *this = bool(_x); }
+			void		flip		()				{ *mWord ^= mMask; }
+
+		private:
+			word_type*	mWord;
+			word_type	mMask;
+		};
+
+		class const_iterator;
+		class iterator;
+
+	public:
+		// Construction
+		explicit	bit_vector	(const allocatorT& _alloc = allocatorT());
+		explicit	bit_vector	(size_type _n, bool _x = false, const allocatorT& _alloc = allocatorT());
+
+		allocator_type get_allocator() const { return allocator_type(mWords.get_allocator()); }
+
+		// Iterators
+		iterator		begin		()			{ return iterator(mWords.data(), 0); }
+		const_iterator	begin		() const	{ return const_iterator(mWords.data(), 0); }
+		iterator		end			()			{ return iterator(mWords.data(), mSize); }
+		const_iterator	end			() const	{ return const_iterator(mWords.data(), mSize); }
+
+		// Size and capacity
+		size_type		size		() const		{ return mSize; }
+		bool			empty		() const		{ return 0 == mSize; }
+		size_type		capacity	() const		{ return mWords.capacity() * WordBits; }
+		void			reserve		(size_type _n)	{ mWords.reserve(wordsFor(_n)); }
+		void			resize		(size_type _n, bool _x = false);
+		void			clear		()				{ mWords.clear(); mSize = 0; }
+
+		// Element access
+		reference		operator[]	(size_type _i)			{ return reference(&mWords[_i / WordBits], bit(_i)); }
+		const_reference	operator[]	(size_type _i) const	{ return test(_i); }
+		bool			test		(size_type _i) const	{ return 0 != (mWords[_i / WordBits] & bit(_i)); }
+		reference		front		()			{ return (*this)[0]; }
+		const_reference	front		() const	{ return test(0); }
+		reference		back		()			{ return (*this)[mSize-1]; }
+		const_reference	back		() const	{ return test(mSize-1); }
+
+		// Word access. Bit i is bit (i % 64) of word i / 64.
+		word_type*			data		()			{ return mWords.data(); }
+		const word_type*	data		() const	{ return mWords.data(); }
+		size_type			word_count	() const	{ return mWords.size(); }
+
+		// Modifiers
+		void			push_back	(bool _x);
+		void			pop_back	();
+		void			set			(size_type _i, bool _x = true)	{ (*this)[_i] = _x; }
+		void			reset		(size_type _i)	{ mWords[_i / WordBits] &= ~bit(_i); }
+		void			flip		(size_type _i)	{ mWords[_i / WordBits] ^= bit(_i); }
+		void			set			();	// Every bit
+		void			reset		();
+		void			flip		();
+		void			swap		(bit_vector& _x)	{ mWords.swap(_x.mWords); rtl::swap(mSize, _x.mSize); }
+
+		// Queries
+		size_type		count		() const;	// Number of set bits
+		bool			any			() const;
+		bool			none		() const	{ return !any(); }
+		bool			all			() const	{ return count() == mSize; }
+		// Searches return size() when there's no set bit
+		size_type		find_first	() const;
+		size_type		find_next	(size_type _prev) const;	// First set bit after _prev
+
+		// Bulk operations. Both vectors must have the same size.
+		bit_vector&		operator&=	(const bit_vector& _x)	{ combine<detail::bit_and>(_x); return *this; }
+		bit_vector&		operator|=	(const bit_vector& _x)	{ combine<detail::bit_or>(_x); return *this; }
+		bit_vector&		operator^=	(const bit_vector& _x)	{ combine<detail::bit_xor>(_x); return *this; }
+		bit_vector&		and_not		(const bit_vector& _x)	{ combine<detail::bit_and_not>(_x); return *this; }
+		// Number of bits set in both vectors, without building their intersection
+		size_type		count_and	(const bit_vector& _x) const;
+
+		bool			operator==	(const bit_vector& _x) const;
+
+	public:
+		// ---- Nested classes ----
+		class const_iterator
+		{
+		public:
+			typedef bool						value_type;
+			typedef bool						reference;
+			typedef void						pointer;
+			typedef typename bit_vector::difference_type	difference_type;
+			typedef random_access_iterator_tag	iterator_category;
+
+			const_iterator	() : mWords(0), mPos(0) {}
+			const_iterator	(const word_type* _words, size_type _pos) : mWords(const_cast<word_type*>(_words)), mPos(_pos) {}
+
+			reference		operator*	() const { return 0 != (mWords[mPos / WordBits] & bit(mPos)); }
+			reference		operator[]	(difference_type n) const { return *(*this + n); }
+
+			const_iterator&	operator++	()		{ ++mPos; return *this; }
+			const_iterator	operator++	(int)	{ const_iterator prev(*this); ++mPos; return prev; }
+			const_iterator&	operator--	()		{ --mPos; return *this; }
+			const_iterator	operator--	(int)	{ const_iterator prev(*this); --mPos; return prev; }
+
+			const_iterator& operator+=	(difference_type n) { mPos += n; return *this; }
+			const_iterator& operator-=	(difference_type n) { mPos -= n; return *this; }
+			const_iterator	operator+	(difference_type n) const { return const_iterator(mWords, mPos + n); }
+			const_iterator	operator-	(difference_type n) const { return const_iterator(mWords, mPos - n); }
+			difference_type	operator-	(const const_iterator& x) const { return difference_type(mPos) - difference_type(x.mPos); }
+
+			bool			operator==	(const const_iterator& x) const { return mPos == x.mPos; }
+			bool			operator!=	(const const_iterator& x) const { return mPos != x.mPos; }
+			bool			operator<	(const const_iterator& x) const { return mPos < x.mPos; }
+
+		protected:
+			word_type*	mWords;
+			size_type	mPos;
+		};
+
+		class iterator : public const_iterator
+		{
+		public:
+			typedef typename bit_vector::reference	reference;
+
+			iterator	() {}
+			iterator	(word_type* _words, size_type _pos) : const_iterator(_words, _pos) {}
+
+			reference	operator*	() const { return reference(&this->mWords[this->mPos / WordBits], bit(this->mPos)); }
+			reference	operator[]	(difference_type n) const { return *(*this + n); }
+
+			iterator&	operator++	()		{ ++this->mPos; return *this; }
+			iterator	operator++	(int)	{ iterator prev(*this); ++this->mPos; return prev; }
+			iterator&	operator--	()		{ --this->mPos; return *this; }
+			iterator	operator--	(int)	{ iterator prev(*this); --this->mPos; return prev; }
+
+			iterator&	operator+=	(difference_type n) { this->mPos += n; return *this; }
+			iterator&	operator-=	(difference_type n) { this->mPos -= n; return *this; }
+			iterator	operator+	(difference_type n) const { return iterator(this->mWords, this->mPos + n); }
+			iterator	operator-	(difference_type n) const { return iterator(this->mWords, this->mPos - n); }
+			difference_type	operator-	(const const_iterator& x) const { return const_iterator::operator-(x); }
+		};
+
+	private:
+		static size_type	wordsFor	(size_type _bits)	{ return (_bits + WordBits - 1) / WordBits; }
+		static word_type	bit			(size_type _i)		{ return word_type(1) << (_i % WordBits); }
+
+		void				clearTail	();	// Zeroes the bits of the last word past size()
+		template<class Op>
+		void				combine		(const bit_vector& _x);
+
+	private:
+		wordsT		mWords;
+		size_type	mSize;
+	};
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Bit vector implementation
+	//------------------------------------------------------------------------------------------------------------------
+	template<class allocatorT>
+	bit_vector<allocatorT>::bit_vector(const allocatorT& _alloc)
+		:mWords(wordAllocT(_alloc))
+		,mSize(0)
+	{
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class allocatorT>
+	bit_vector<allocatorT>::bit_vector(size_type _n, bool _x, const allocatorT& _alloc)
+		:mWords(wordsFor(_n), _x ? ~word_type(0) : word_type(0), wordAllocT(_alloc))
+		,mSize(_n)
+	{
+		clearTail();
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class allocatorT>
+	void bit_vector<allocatorT>::resize(size_type _n, bool _x)
+	{
+		if(_x && _n > mSize && mSize % WordBits)
+			mWords.back() |= ~word_type(0) << (mSize % WordBits);	// Fill the tail of the last word
+		mWords.resize(wordsFor(_n), _x ? ~word_type(0) : word_type(0));
+		mSize = _n;
+		clearTail();
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class allocatorT>
+	void bit_vector<allocatorT>::push_back(bool _x)
+	{
+		if(0 == mSize % WordBits)
+			mWords.push_back(0);
+		if(_x)
+			mWords.back() |= bit(mSize);
+		++mSize;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class allocatorT>
+	void bit_vector<allocatorT>::pop_back()
+	{
+		assert(mSize);
+		--mSize;
+		// Keep exactly wordsFor(mSize) words, push_back relies on it
+		if(0 == mSize % WordBits)
+			mWords.pop_back();
+		else
+			clearTail();
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class allocatorT>
+	void bit_vector<allocatorT>::set()
+	{
+		for(size_type i = 0; i < mWords.size(); ++i)
+			mWords[i] = ~word_type(0);
+		clearTail();
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class allocatorT>
+	void bit_vector<allocatorT>::reset()
+	{
+		for(size_type i = 0; i < mWords.size(); ++i)
+			mWords[i] = 0;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class allocatorT>
+	void bit_vector<allocatorT>::flip()
+	{
+		for(size_type i = 0; i < mWords.size(); ++i)
+			mWords[i] = ~mWords[i];
+		clearTail();
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class allocatorT>
+	typename bit_vector<allocatorT>::size_type bit_vector<allocatorT>::count() const
+	{
+		size_type n = 0;
+		for(size_type i = 0; i < mWords.size(); ++i)
+			n += popcount(mWords[i]);
+		return n;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class allocatorT>
+	bool bit_vector<allocatorT>::any() const
+	{
+		for(size_type i = 0; i < mWords.size(); ++i)
+		{
+			if(mWords[i])
+				return true;
+		}
+		return false;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class allocatorT>
+	typename bit_vector<allocatorT>::size_type bit_vector<allocatorT>::find_first() const
+	{
+		for(size_type i = 0; i < mWords.size(); ++i)
+		{
+			if(mWords[i])
+				return i * WordBits + lowest_bit(mWords[i]);
+		}
+		return mSize;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class allocatorT>
+	typename bit_vector<allocatorT>::size_type bit_vector<allocatorT>::find_next(size_type _prev) const
+	{
+		size_type start = _prev + 1;
+		if(start >= mSize)
+			return mSize;
+		size_type i = start / WordBits;
+		// Bits of the first word up to _prev don't count
+		word_type word = mWords[i] & (~word_type(0) << (start % WordBits));
+		for(;;)
+		{
+			if(word)
+				return i * WordBits + lowest_bit(word);
+			if(++i == mWords.size())
+				return mSize;
+			word = mWords[i];
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class allocatorT>
+	typename bit_vector<allocatorT>::size_type bit_vector<allocatorT>::count_and(const bit_vector& _x) const
+	{
+		assert(mSize == _x.mSize);
+		size_type n = 0;
+		for(size_type i = 0; i < mWords.size(); ++i)
+			n += popcount(mWords[i] & _x.mWords[i]);
+		return n;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class allocatorT>
+	bool bit_vector<allocatorT>::operator==(const bit_vector& _x) const
+	{
+		if(mSize != _x.mSize)
+			return false;
+		for(size_type i = 0; i < mWords.size(); ++i)
+		{
+			if(mWords[i] != _x.mWords[i])
+				return false;
+		}
+		return true;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class allocatorT>
+	void bit_vector<allocatorT>::clearTail()
+	{
+		if(mSize % WordBits)
+			mWords.back() &= ~(~word_type(0) << (mSize % WordBits));
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// The vector loops use unaligned loads: words come from the allocator with no alignment guarantee beyond their own,
+	// and current processors run unaligned loads of aligned data at full speed.
+	template<class allocatorT>
+	template<class Op>
+	void bit_vector<allocatorT>::combine(const bit_vector& _x)
+	{
+		assert(mSize == _x.mSize);
+		word_type* a = mWords.data();
+		const word_type* b = _x.mWords.data();
+		size_type n = mWords.size();
+		size_type i = 0;
+#if defined(__AVX2__)
+		for(; i + 4 <= n; i += 4)
+		{
+			__m256i wa = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+			__m256i wb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(a + i), Op::wide(wa, wb));
+		}
+#elif defined(RTL_BIT_VECTOR_SSE2)
+		for(; i + 2 <= n; i += 2)
+		{
+			__m128i wa = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+			__m128i wb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(a + i), Op::wide(wa, wb));
+		}
+#endif
+		for(; i < n; ++i)
+			a[i] = Op::scalar(a[i], b[i]);
+	}
+
+	// Specialized algorithms
+	template<class allocatorT>
+	void swap(bit_vector<allocatorT>& a, bit_vector<allocatorT>& b)
+	{
+		a.swap(b);
+	}
+}	// namespace rtl
+
+#undef RTL_BIT_VECTOR_SSE2	// Only meant for this header
+
+#endif // _RTL_BIT_VECTOR_H_
@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Standard templates library. Freestanding implementation.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Bit operations
+
+#ifndef _RTL_BITOPS_H_
+#define _RTL_BITOPS_H_
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace rtl
+{
+	// Index of the most significant set bit. _x must not be zero.
+	inline unsigned highest_bit(unsigned long long _x)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return 63 - __builtin_clzll(_x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		_BitScanReverse64(&index, _x);
+		return index;
+#else
+		unsigned index = 0;
+		while(_x >>= 1)
+			++index;
+		return index;
+#endif
+	}
+
+	// Index of the least significant set bit. _x must not be zero.
+	inline unsigned lowest_bit(unsigned long long _x)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_ctzll(_x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		_BitScanForward64(&index, _x);
+		return index;
+#else
+		unsigned index = 0;
+		while(!(_x & 1))
+		{
+			_x >>= 1;
+			++index;
+		}
+		return index;
+#endif
+	}
+
+	// Number of set bits. GCC and Clang emit a single popcnt instruction when the target has it (-mpopcnt or
+	// -march=native), MSVC always does on x64.
+	inline unsigned popcount(unsigned long long _x)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_popcountll(_x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		return unsigned(__popcnt64(_x));
+#else
+		_x = _x - ((_x >> 1) & 0x5555555555555555ull);
+		_x = (_x & 0x3333333333333333ull) + ((_x >> 2) & 0x3333333333333333ull);
+		_x = (_x + (_x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+		return unsigned((_x * 0x0101010101010101ull) >> 56);
+#endif
+	}
+}	// namespace rtl
+
+#endif // _RTL_BITOPS_H_
@@ -0,0 +1,313 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Standard templates library. Freestanding implementation.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Thread caching allocator
+
+#ifndef _RTL_CACHING_ALLOCATOR_H_
+#define _RTL_CACHING_ALLOCATOR_H_
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <new>
+
+#include <bitops.h>
+
+namespace rtl
+{
+	namespace detail
+	{
+		// ----- Size classes -----
+		// Requests are rounded up to a size class: multiples of 16 bytes up to 128, then four classes per power of two,
+		// which wastes at most 25% of each block. Bigger requests bypass the caches.
+		const size_t SmallClassStep		= 16;
+		const size_t SmallClassLimit	= 128;
+		const size_t MaxCachedSize		= 32 * 1024;
+		const size_t SizeClassCount		= 40;
+		// Memory is taken from the system in spans of at least this size, then carved into blocks of one class
+		const size_t SpanSize			= 64 * 1024;
+
+		inline size_t size_class(size_t _bytes)
+		{
+			if(_bytes <= SmallClassLimit)
+				return _bytes ? (_bytes - 1) / SmallClassStep : 0;
+			unsigned shift = highest_bit(_bytes - 1) - 2;	// Each power of two splits in 4 steps of 1 << shift
+			return SmallClassLimit / SmallClassStep + (shift - 5) * 4 + ((_bytes - 1) >> shift) - 4;
+		}
+
+		inline size_t class_size(size_t _class)
+		{
+			const size_t smallClasses = SmallClassLimit / SmallClassStep;
+			if(_class < smallClasses)
+				return (_class + 1) * SmallClassStep;
+			size_t shift = (_class - smallClasses) / 4 + 5;
+			return ((_class - smallClasses) % 4 + 5) << shift;
+		}
+
+		// Blocks moved at once between a thread cache and the central pool: 64 small ones, 2 of the biggest
+		inline size_t batch_size(size_t _class)
+		{
+			size_t n = MaxCachedSize / 8 / class_size(_class);
+			return n < 2 ? 2 : (n > 64 ? 64 : n);
+		}
+
+		// Free blocks are linked through their first word
+		struct free_block
+		{
+			free_block* next;
+		};
+
+		// ----- Central pool -----
+		// Free lists shared by every thread, one per size class, each behind its own spin lock. Threads only come here
+		// to move whole batches, so the locks are held briefly and seldom. Spans are never returned to the system.
+		class central_pool
+		{
+		public:
+			// Never destroyed: thread caches may return blocks to it while static objects are being destroyed
+			static central_pool& instance()
+			{
+				alignas(central_pool) static char storage[sizeof(central_pool)];
+				static central_pool* pool = new(storage) central_pool;
+				return *pool;
+			}
+
+			// Pops up to _n blocks of a class, carving a new span if the list is empty. Returns them linked.
+			free_block*	take	(size_t _class, size_t _n)
+			{
+				classList& list = mLists[_class];
+				for(;;)
+				{
+					list.lock();
+					if(list.head)
+					{
+						free_block* first = list.head;
+						free_block* last = first;
+						for(size_t i = 1; i < _n && last->next; ++i)
+							last = last->next;
+						list.head = last->next;
+						list.unlock();
+						last->next = 0;
+						return first;
+					}
+					list.unlock();
+					// Allocate outside the lock, so other threads can keep taking and giving meanwhile
+					free_block* first;
+					free_block* last;
+					carve(_class, first, last);
+					give(_class, first, last);
+				}
+			}
+
+			// Pushes the linked blocks [_first, _last]
+			void		give	(size_t _class, free_block* _first, free_block* _last)
+			{
+				classList& list = mLists[_class];
+				list.lock();
+				_last->next = list.head;
+				list.head = _first;
+				list.unlock();
+			}
+
+		private:
+			struct alignas(64) classList	// One cache line per class, so classes don't contend
+			{
+				std::atomic<bool>	locked;
+				free_block*			head;
+
+				void lock	() { while(locked.exchange(true, std::memory_order_acquire)) {} }
+				void unlock	() { locked.store(false, std::memory_order_release); }
+			};
+
+			central_pool()
+			{
+				for(size_t i = 0; i < SizeClassCount; ++i)
+				{
+					mLists[i].locked.store(false);
+					mLists[i].head = 0;
+				}
+			}
+
+			static void carve(size_t _class, free_block*& _first, free_block*& _last)
+			{
+				size_t blockSize = class_size(_class);
+				size_t count = SpanSize / blockSize < 8 ? 8 : SpanSize / blockSize;
+				char* span = new char[count * blockSize];
+				for(size_t i = 0; i + 1 < count; ++i)
+					reinterpret_cast<free_block*>(span + i * blockSize)->next = reinterpret_cast<free_block*>(span + (i+1) * blockSize);
+				_first = reinterpret_cast<free_block*>(span);
+				_last = reinterpret_cast<free_block*>(span + (count-1) * blockSize);
+				_last->next = 0;
+			}
+
+			classList	mLists[SizeClassCount];
+		};
+
+		// ----- Thread cache -----
+		// Per thread free lists. Allocation and deallocation take no lock while the lists have blocks, or room.
+		// Blocks don't belong to the thread that allocated them: a block freed by another thread just joins that
+		// thread's cache, and flows back to the central pool when that cache overflows. So producer/consumer patterns
+		// work without any cross-thread bookkeeping.
+		// Trivially destructible, so it can still be used (through the central pool) after the thread's cleanup.
+		struct thread_cache
+		{
+			free_block*	heads[SizeClassCount];
+			size_t		counts[SizeClassCount];
+			bool		registered;	// Whether the cleanup for this thread has been set up
+			bool		dead;		// Set once the thread is exiting and the cache has been flushed
+
+			// Returns every block to the central pool
+			void flush()
+			{
+				for(size_t c = 0; c < SizeClassCount; ++c)
+				{
+					free_block* last = heads[c];
+					if(!last)
+						continue;
+					while(last->next)
+						last = last->next;
+					central_pool::instance().give(c, heads[c], last);
+					heads[c] = 0;
+					counts[c] = 0;
+				}
+			}
+		};
+
+		inline thread_cache& local_cache()
+		{
+			static thread_local thread_cache cache;	// Zero initialized
+			return cache;
+		}
+
+		// Flushes the thread's cache when the thread exits
+		struct thread_cache_cleanup
+		{
+			~thread_cache_cleanup()
+			{
+				thread_cache& cache = local_cache();
+				cache.flush();
+				cache.dead = true;
+			}
+		};
+
+		inline void register_cache_cleanup()
+		{
+			static thread_local thread_cache_cleanup cleanup;
+			(void)cleanup;
+			local_cache().registered = true;
+		}
+
+		//--------------------------------------------------------------------------------------------------------------
+		inline void* cached_allocate(size_t _bytes)
+		{
+			if(_bytes > MaxCachedSize)
+				return new char[_bytes];
+			size_t c = size_class(_bytes);
+			thread_cache& cache = local_cache();
+			if(!cache.heads[c])
+			{
+				if(cache.dead)
+				{
+					// The thread is exiting: serve the block straight from the central pool
+					free_block* block = central_pool::instance().take(c, 1);
+					return block;
+				}
+				if(!cache.registered)
+					register_cache_cleanup();
+				free_block* batch = central_pool::instance().take(c, batch_size(c));
+				size_t n = 0;
+				for(free_block* b = batch; b; b = b->next)
+					++n;
+				cache.heads[c] = batch;
+				cache.counts[c] = n;
+			}
+			free_block* block = cache.heads[c];
+			cache.heads[c] = block->next;
+			--cache.counts[c];
+			return block;
+		}
+
+		//--------------------------------------------------------------------------------------------------------------
+		inline void cached_deallocate(void* _p, size_t _bytes)
+		{
+			if(!_p)
+				return;
+			if(_bytes > MaxCachedSize)
+			{
+				delete[] static_cast<char*>(_p);
+				return;
+			}
+			size_t c = size_class(_bytes);
+			free_block* block = static_cast<free_block*>(_p);
+			thread_cache& cache = local_cache();
+			if(cache.dead)
+			{
+				central_pool::instance().give(c, block, block);
+				return;
+			}
+			block->next = cache.heads[c];
+			cache.heads[c] = block;
+			// Past two batches, keep the most recently freed one (the warmest in cache) and give back the rest
+			size_t batch = batch_size(c);
+			if(++cache.counts[c] > 2 * batch)
+			{
+				free_block* keep = block;
+				for(size_t i = 1; i < batch; ++i)
+					keep = keep->next;
+				free_block* first = keep->next;
+				free_block* last = first;
+				while(last->next)
+					last = last->next;
+				keep->next = 0;
+				central_pool::instance().give(c, first, last);
+				cache.counts[c] = batch;
+			}
+		}
+	}	// namespace detail
+
+	// ---------------- Thread caching allocator ---------------
+	// Drop-in replacement of rtl::allocator for allocation heavy, multithreaded code. Blocks up to 32 KB come from
+	// per thread caches of size class free lists, refilled from and returned to a central pool in batches, so small
+	// allocations rarely synchronize with other threads. Stateless: every instance can free what another allocated.
+	//		vector<int, caching_allocator<int>> v;
+	//		dictionary<Item, 64, caching_allocator<Item>> d;
+	template < class T >
+	class caching_allocator
+	{
+	public:
+		typedef size_t		size_type;
+		typedef ptrdiff_t	difference_type;
+		typedef T*			pointer;
+		typedef const T*	const_pointer;
+		typedef T&			reference;
+		typedef const T&	const_reference;
+		typedef T			value_type;
+		typedef void*		void_pointer;
+		typedef const void*	const_void_pointer;
+
+		template<class U>
+		struct rebind { typedef caching_allocator<U> other; };
+
+		caching_allocator() {}
+		template<class U>
+		caching_allocator(const caching_allocator<U>&) {}
+
+		pointer			address		(reference x) const			{ return &x; }
+		const_pointer	address		(const_reference x) const	{ return &x; }
+
+		pointer			allocate	(size_type n, const void * = 0)
+		{
+			assert(n <= max_size());
+			return static_cast<pointer>(detail::cached_allocate(n * sizeof(T)));
+		}
+		void			deallocate	(pointer p, size_type n)	{ detail::cached_deallocate(p, n * sizeof(T)); }
+		size_type		max_size	() const					{ return size_type(-1) / sizeof(T); }
+
+		void			construct	(pointer _p, const_reference _x = T())	{ new(_p) T(_x); }
+		void			construct	(pointer _p, T&& _x)					{ new(_p) T(static_cast<T&&>(_x)); }
+		void			destroy		(pointer _p)							{ _p->~T(); }
+
+		bool			operator==	(const caching_allocator&) const	{ return true; }
+	};
+}	// namespace rtl
+
+#endif // _RTL_CACHING_ALLOCATOR_H_
@@ -5,13 +5,225 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Dictionary
 
+#ifndef _RTL_DICTIONARY_H_
+#define _RTL_DICTIONARY_H_
+
+#include <cstring>
+
 #include <iterator_tags.h>
 #include <memory.h>
 #include <utility.h>
 #include <vector.h>
 
+// Define RTL_DICTIONARY_STATS before including this header to make every dictionary record lookup statistics,
+// available through dictionary::stats(). When it is not defined, instrumentation compiles to nothing.
+// Statistics are plain counters, so dictionary::get() doesn't record them: it is the lookup readers may run
+// concurrently. Every other lookup is counted.
+// Statistics change the layout of dictionary, so define it for the whole program (e.g. on the compiler command line)
+// or not at all: translation units that disagree on it break the one definition rule.
+#ifdef RTL_DICTIONARY_STATS
+#define RTL_DICTIONARY_STAT(x) x
+#else
+#define RTL_DICTIONARY_STAT(x)
+#endif
+
 namespace rtl
 {
+#ifdef RTL_DICTIONARY_STATS
+	// Lookup statistics of a dictionary. Counters are plain integers: they are only accurate while one thread at a
+	// time uses the dictionary.
+	struct dictionary_stats
+	{
+		// Chains longer than this are counted in the last entry of the histogram
+		static const unsigned MaxChainLength = 15;
+
+		// Recorded by every lookup (including the one before each insertion)
+		unsigned long long	lookups;
+		unsigned long long	hits;
+		unsigned long long	misses;
+		unsigned long long	key_comparisons;	// keyComp calls
+		unsigned long long	chain_length[MaxChainLength+1];	// Lookups by number of slots compared
+		// Measured on the table when stats() is called
+		size_t				buckets;
+		size_t				empty_buckets;
+		size_t				longest_bucket;
+
+		double hit_ratio				() const { return lookups ? double(hits) / lookups : 0.0; }
+		double comparisons_per_lookup	() const { return lookups ? double(key_comparisons) / lookups : 0.0; }
+	};
+#endif
+
+	// Key of a dictionary slot, stored as a small string. Keys of up to InlineCapacity characters live inside the key
+	// itself: the characters, zero padding, and a last byte holding InlineCapacity minus the length, which doubles as
+	// the terminator of the longest inline keys. Longer keys are allocated apart by the dictionary; the first word
+	// points to them and the last byte is ExternalTag.
+	// Inline keys are on the same cache line as the rest of the slot, and comparing two of them takes two word compares.
+	class dictionary_key
+	{
+	public:
+		static const unsigned		InlineCapacity = 15;
+		static const unsigned char	ExternalTag = 0xff;
+
+		dictionary_key() { mWords[0] = 0; mWords[1] = 0; bytes()[InlineCapacity] = char(InlineCapacity); }
+		// Copies _s if it fits inline. Otherwise only points to it, which is enough to look it up.
+		explicit dictionary_key(const char * _s);
+
+		bool			is_inline	() const	{ return ExternalTag != static_cast<unsigned char>(bytes()[InlineCapacity]); }
+		const char *	c_str		() const	{ return is_inline() ? bytes() : external(); }
+		// Points the key to an out of line string, which the caller owns
+		void			set_external(char * _s);
+		char *			external	() const	{ return reinterpret_cast<char*>(static_cast<size_t>(mWords[0])); }
+
+		bool			operator==	(const dictionary_key& _x) const;
+
+	private:
+		char *			bytes	()			{ return reinterpret_cast<char*>(mWords); }
+		const char *	bytes	() const	{ return reinterpret_cast<const char*>(mWords); }
+
+	private:
+		unsigned long long	mWords[2];
+	};
+
+	//------------------------------------------------------------------------------------------------------------------
+	inline dictionary_key::dictionary_key(const char * _s)
+	{
+		mWords[0] = 0;
+		mWords[1] = 0;
+		unsigned length = 0;
+		while(_s && length <= InlineCapacity && _s[length] != '\0')
+			++length;
+		if(!_s || length > InlineCapacity)
+		{
+			set_external(const_cast<char*>(_s));
+			return;
+		}
+		char * chars = bytes();
+		for(unsigned i = 0; i < length; ++i)
+			chars[i] = _s[i];
+		chars[InlineCapacity] = char(InlineCapacity - length);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	inline void dictionary_key::set_external(char * _s)
+	{
+		mWords[0] = reinterpret_cast<size_t>(_s);
+		mWords[1] = 0;
+		bytes()[InlineCapacity] = char(ExternalTag);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	inline bool dictionary_key::operator==(const dictionary_key& _x) const
+	{
+		// Equal inline keys have equal words. An inline key and an external one differ in length.
+		if(mWords[0] == _x.mWords[0] && mWords[1] == _x.mWords[1])
+			return true;
+		if(is_inline() || _x.is_inline())
+			return false;
+		const char * a = external();
+		const char * b = _x.external();
+		if(!a || !b)
+			return false;
+		unsigned i = 0;
+		while(a[i] != '\0' && a[i] == b[i])
+			++i;
+		return a[i] == b[i];
+	}
+
+	// Chain of slots of a dictionary bucket. Takes a single pointer: an empty bucket is null, and a non empty one points
+	// to a block holding its size and capacity followed by the slots. The owner passes in the allocator, so a bucket
+	// stores none.
+	template<class slotT, class allocatorT>
+	class dictionary_bucket
+	{
+	public:
+		typedef typename allocatorT::template rebind<char>::other	blockAllocT;
+		typedef	typename rtl::allocator_traits<allocatorT>::size_type	size_type;
+
+		dictionary_bucket() : mBlock(0) {}
+
+		size_type		size	() const		{ return mBlock ? mBlock->size : 0; }
+		bool			empty	() const		{ return 0 == mBlock; }
+		slotT*			data	()				{ return mBlock ? mBlock->slots() : 0; }
+		const slotT*	data	() const		{ return mBlock ? mBlock->slots() : 0; }
+		slotT&			operator[](size_type n)			{ return mBlock->slots()[n]; }
+		const slotT&	operator[](size_type n) const	{ return mBlock->slots()[n]; }
+		slotT&			front	()				{ return mBlock->slots()[0]; }
+		slotT&			back	()				{ return mBlock->slots()[mBlock->size-1]; }
+
+		void			push_back	(const slotT& _x, allocatorT& _alloc);
+		// Makes room for _n slots, so the next pushes don't move the existing ones
+		void			reserve		(size_type _n, allocatorT& _alloc);
+		// Destroys every slot and releases the block
+		void			clear		(allocatorT& _alloc);
+
+	private:
+		static const size_type InitialCapacity = 2;
+
+		struct header
+		{
+			size_type size;
+			size_type capacity;
+
+			slotT* slots() { return reinterpret_cast<slotT*>(this + 1); }
+		};
+
+		static size_type	blockBytes	(size_type _capacity) { return sizeof(header) + _capacity * sizeof(slotT); }
+
+	private:
+		header*	mBlock;
+	};
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Dictionary bucket implementation
+	//------------------------------------------------------------------------------------------------------------------
+	template<class slotT, class allocatorT>
+	void dictionary_bucket<slotT,allocatorT>::push_back(const slotT& _x, allocatorT& _alloc)
+	{
+		size_type n = size();
+		if(!mBlock || n == mBlock->capacity)
+			reserve(mBlock ? 2 * mBlock->capacity : InitialCapacity, _alloc);
+		new(&mBlock->slots()[n]) slotT(_x);
+		++mBlock->size;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class slotT, class allocatorT>
+	void dictionary_bucket<slotT,allocatorT>::reserve(size_type _n, allocatorT& _alloc)
+	{
+		if(mBlock && _n <= mBlock->capacity)
+			return;
+		// Move the slots into a bigger block
+		size_type n = size();
+		blockAllocT blockAlloc(_alloc);
+		header* block = reinterpret_cast<header*>(allocator_traits<blockAllocT>::allocate(blockAlloc, blockBytes(_n)));
+		block->size = n;
+		block->capacity = _n;
+		for(size_type i = 0; i < n; ++i)
+			new(&block->slots()[i]) slotT(mBlock->slots()[i]);
+		clear(_alloc);
+		mBlock = block;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class slotT, class allocatorT>
+	void dictionary_bucket<slotT,allocatorT>::clear(allocatorT& _alloc)
+	{
+		if(!mBlock)
+			return;
+		for(size_type i = 0; i < mBlock->size; ++i)
+			mBlock->slots()[i].~slotT();
+		blockAllocT blockAlloc(_alloc);
+		allocator_traits<blockAllocT>::deallocate(blockAlloc, reinterpret_cast<char*>(mBlock), blockBytes(mBlock->capacity));
+		mBlock = 0;
+	}
+
+	namespace detail
+	{
+		template<class dictionaryT> struct dictionary_bulk;
+	}
+
+	// NBuckets is the initial number of buckets. The table doubles them whenever it holds more than max_load_factor()
+	// keys per bucket.
 	template<class T, unsigned NBuckets, class allocatorT = rtl::allocator<T>>
 	class dictionary
 	{
@@ -27,36 +239,108 @@ namespace rtl
 		typedef	typename rtl::allocator_traits<allocatorT>::size_type		size_type;
 		typedef typename rtl::allocator_traits<allocatorT>::difference_type	difference_type;
 
-		typedef rtl::pair<char*, T>				slotT;
-		typedef rtl::vector<slotT,allocatorT>	bucketT;
+		typedef rtl::pair<dictionary_key, T>							slotT;
+		typedef dictionary_bucket<slotT,allocatorT>						bucketT;
+		typedef typename allocatorT::template rebind<bucketT>::other	tableAllocT;
+		typedef typename allocatorT::template rebind<char>::other		keyAllocT;
 
 	public:
 		dictionary(const allocatorT& _alloc = allocatorT());
 		dictionary(const dictionary<T,NBuckets,allocatorT>&);
 		dictionary& operator=(const dictionary<T,NBuckets,allocatorT>&);
-		~dictionary() {}
+		~dictionary();
 
-		allocator_type get_allocator() const { return mAlloc; }
+		allocator_type get_allocator() const { return alloc(); }
 
 	public:
 		// Size and
 		size_type		size		() const		{ return mSize; }
-		size_type		max_size	() const		{ return mAlloc.max_size; }
-		bool			empty		() const		{ 0 == mSize; }
+		size_type		max_size	() const		{ return alloc().max_size(); }
+		bool			empty		() const		{ return 0 == mSize; }
+		size_type		bucket_count() const		{ return mNumBuckets; }
 
 		T&				find		(const char * _key);
 		T&				operator[]	(const char * _key);
 		bool			contains	(const char * _key);
+		void			clear		();
+
+		// Read-only lookup. Never inserts nor advances an incremental rehash, so it is safe to call concurrently on a
+		// dictionary nobody modifies (e.g. a published snapshot). Returns null if the key is missing.
+		const T*		get			(const char * _key) const;
+
+		// Batched lookup. Resolves _n keys at once, overlapping the cache misses of every lookup in the batch.
+		// Unlike find, missing keys are not inserted: their result is set to null. Returns the number of hits.
+		// Results stay valid until the next call that may insert or migrate (anything but get and stats).
+		size_type		find_batch		(const char * const * _keys, size_type _n, T** _results);
+		size_type		contains_batch	(const char * const * _keys, size_type _n, bool* _results);
+
+		// Rehash policy
+		unsigned		max_load_factor	() const		{ return mAllocLoadFactor.second(); }
+		void			max_load_factor	(unsigned _f)	{ mAllocLoadFactor.second() = _f ? _f : 1; }
+		// In incremental mode, growing doesn't rehash the whole table at once. The old table is kept alongside the new
+		// one, and every operation migrates a share of its buckets: RehashStep, or more if needed to finish before the
+		// table has to grow again. Keys stay in their old bucket until it's migrated. New buckets aren't even initialized
+		// before that, so growing never touches the whole new table at once.
+		// Disabling incremental mode finishes any pending migration.
+		bool			incremental_rehash	() const	{ return mIncremental; }
+		void			incremental_rehash	(bool _enable);
+		bool			rehashing		() const		{ return 0 != mOldBuckets; }
+
+#ifdef RTL_DICTIONARY_STATS
+		// Instrumentation
+		dictionary_stats	stats		() const;
+		void				reset_stats	();
+#endif
 
 	private:
+		// Parallel bulk loading, see dictionary_bulk.h
+		template<class dictionaryT> friend struct detail::dictionary_bulk;
+
+		// Keys are resolved in groups of this size, so the hashes of a group fit in a small stack array
+		static const unsigned			BatchGroupSize = 16;
+		// Least number of old buckets migrated by each operation while an incremental rehash is in progress
+		static const unsigned			RehashStep = 2;
+		static const unsigned			DefaultMaxLoadFactor = 4;
+
+		// Records statistics (when they're compiled in) unless _recordStats is false
+		slotT*							lookup		(const dictionary_key& _key, unsigned _hash, bool _recordStats = true) const;
+		slotT*							findSlot	(bucketT& _bucket, const dictionary_key& _key) const;
+		T&								insert		(const dictionary_key& _key, unsigned _hash);
+		// Bucket currently holding the keys of _hash: its old bucket while that one isn't migrated, else the new one
+		bucketT&						bucketFor	(unsigned _hash) const;
+		// Whether a bucket of mBuckets has been initialized. Only those of migrated old buckets are, while rehashing.
+		bool							isLive		(size_type _bucket) const	{ return !mOldBuckets || _bucket % mNumOldBuckets < mMigrated; }
+		void							grow		();
+		// Old buckets to migrate per operation, so the migration is over before the table has to grow again
+		size_type						rehashStep	() const;
+		void							migrate		(size_type _nBuckets);
+		// Initializes the buckets of mBuckets a pending migration hasn't reached yet
+		void							initPendingBuckets();
+		void							copyFrom	(const dictionary<T,NBuckets,allocatorT>& _x);
+		// Unless _zeroed is false, every bucket starts empty. Otherwise they are left uninitialized.
+		bucketT*						createTable	(size_type _nBuckets, bool _zeroed = true);
+		void							destroyTable(bucketT* _table, size_type _nBuckets);
+
 		static unsigned					hash	(const char * _key);
-		static bool						keyComp	(const char * _a, const char * _b);
-		static void						keyCopy	(char *& _dst, const char * _src);
+		static bool						keyComp	(const dictionary_key& _a, const dictionary_key& _b) { return _a == _b; }
+		void							keyCopy	(dictionary_key& _dst, const dictionary_key& _src);
+		void							keyFree	(dictionary_key& _key);
+
+		allocatorT&						alloc	()			{ return mAllocLoadFactor.first(); }
+		const allocatorT&				alloc	() const	{ return mAllocLoadFactor.first(); }
 
 	private:
 		size_type	mSize;
-		allocatorT	mAlloc;
-		bucketT		mBuckets[NBuckets];
+		bucketT*	mBuckets;		// Null until the first insertion
+		size_type	mNumBuckets;
+		bucketT*	mOldBuckets;	// Table being drained by an incremental rehash, null otherwise
+		size_type	mNumOldBuckets;
+		size_type	mMigrated;		// Number of leading buckets of mOldBuckets already moved into mBuckets
+		compressed_pair<allocatorT, unsigned>	mAllocLoadFactor;	// The allocator and the max load factor
+		bool		mIncremental;
+#ifdef RTL_DICTIONARY_STATS
+		mutable dictionary_stats	mStats;	// Only lookup counters are kept up to date here
+#endif
 	};
 
 	//------------------------------------------------------------------------------------------------------------------
@@ -65,104 +349,427 @@ namespace rtl
 	template<class T, unsigned NB, class allocatorT>
 	dictionary<T,NB,allocatorT>::dictionary(const allocatorT& _alloc)
 		:mSize(0)
-		,mAlloc(_alloc)
+		,mBuckets(0)
+		,mNumBuckets(NB ? NB : 1)
+		,mOldBuckets(0)
+		,mNumOldBuckets(0)
+		,mMigrated(0)
+		,mAllocLoadFactor(_alloc, unsigned(DefaultMaxLoadFactor))
+		,mIncremental(false)
 	{
+		RTL_DICTIONARY_STAT(reset_stats());
 	}
 
 	//------------------------------------------------------------------------------------------------------------------
 	template<class T, unsigned nb1, class allocatorT>
 	dictionary<T,nb1,allocatorT>::dictionary(const dictionary<T,nb1,allocatorT>& x)
 		:mSize(0)
-		,mAlloc(x.mAlloc)
+		,mBuckets(0)
+		,mNumBuckets(x.mNumBuckets)
+		,mOldBuckets(0)
+		,mNumOldBuckets(0)
+		,mMigrated(0)
+		,mAllocLoadFactor(x.mAllocLoadFactor)
+		,mIncremental(x.mIncremental)
 	{
-		for(unsinged i = 0; i < nb1; ++i)
-		{
-			unsigned bucketSize = x.mBuckets[i].size();
-			for(unsigned j = 0; j < bucketSize; ++j)
-			{
-				pair<const char*,T>& slot = x.mBuckets[i][j];
-				operator[](slot.first) = slot.second;
-			}
-		}
+		RTL_DICTIONARY_STAT(reset_stats());
+		copyFrom(x);
 	}
 
 	//------------------------------------------------------------------------------------------------------------------
 	template<class T, unsigned nb1, class allocatorT>
 	dictionary<T,nb1,allocatorT>& dictionary<T,nb1,allocatorT>::operator=(const dictionary<T,nb1,allocatorT>& x)
-		:mSize(0)
-		,mAlloc(x.mAlloc)
 	{
-		for(unsinged i = 0; i < nb1; ++i)
+		if(this != &x)
 		{
-			unsigned bucketSize = x.mBuckets[i].size();
-			for(unsigned j = 0; j < bucketSize; ++j)
-			{
-				pair<const char*,T>& slot = x.mBuckets[i][j];
-				operator[](slot.first) = slot.second;
-			}
+			clear();
+			mAllocLoadFactor.second() = x.mAllocLoadFactor.second();
+			mIncremental = x.mIncremental;
+			copyFrom(x);
 		}
 		return *this;
 	}
 
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned nb1, class allocatorT>
+	dictionary<T,nb1,allocatorT>::~dictionary()
+	{
+		initPendingBuckets();
+		if(mOldBuckets)
+			destroyTable(mOldBuckets, mNumOldBuckets);
+		if(mBuckets)
+			destroyTable(mBuckets, mNumBuckets);
+	}
+
 	//------------------------------------------------------------------------------------------------------------------
 	template<class T, unsigned nb1, class allocatorT>
 	T& dictionary<T,nb1,allocatorT>::find(const char * _key)
 	{
-		unsigned bucketId = hash(_key);
-		bucketT& bucket = mBuckets[bucketId];
-		for (bucketT::iterator i = 0; i != bucket.end(); ++i)
-		{
-			if(keyComp(iterator->first,_key))
-			{
-				return iterator->second;
-			}
-		}
+		RTL_PROFILE(dictionary_find);
+		migrate(rehashStep());
+		dictionary_key key(_key);
+		unsigned keyHash = hash(_key);
+		slotT* slot = lookup(key, keyHash);
+		if(slot)
+			return slot->second;
 		// Found nothing, create a new entry
-		// Create a new slot
-		slotT slot(0,T());
-		keyCopy(slot.first, _key);
-		// Push it into the bucket
-		bucket.push_back(slot);
-		return slot.second;
+		return insert(key, keyHash);
 	}
 
 	//------------------------------------------------------------------------------------------------------------------
 	template<class T, unsigned nb1, class allocatorT>
 	T& dictionary<T,nb1,allocatorT>::operator[](const char * _key)
 	{
-		unsigned bucketId = hash(_key);
-		bucketT& bucket = mBuckets[bucketId];
-		for (bucketT::iterator i = 0; i != bucket.end(); ++i)
+		RTL_PROFILE(dictionary_find);
+		migrate(rehashStep());
+		dictionary_key key(_key);
+		unsigned keyHash = hash(_key);
+		slotT* slot = lookup(key, keyHash);
+		if(slot)
+			return slot->second;
+		// Found nothing, create a new entry
+		return insert(key, keyHash);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned nb1, class allocatorT>
+	bool dictionary<T,nb1,allocatorT>::contains(const char * _key)
+	{
+		migrate(rehashStep());
+		return 0 != lookup(dictionary_key(_key), hash(_key));
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned nb1, class allocatorT>
+	const T* dictionary<T,nb1,allocatorT>::get(const char * _key) const
+	{
+		slotT* slot = lookup(dictionary_key(_key), hash(_key), false);
+		return slot ? &slot->second : 0;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned nb1, class allocatorT>
+	void dictionary<T,nb1,allocatorT>::clear()
+	{
+		initPendingBuckets();
+		if(mOldBuckets)
+		{
+			destroyTable(mOldBuckets, mNumOldBuckets);
+			mOldBuckets = 0;
+			mNumOldBuckets = 0;
+			mMigrated = 0;
+		}
+		for(size_type i = 0; mBuckets && i < mNumBuckets; ++i)
+		{
+			bucketT& bucket = mBuckets[i];
+			for(size_type j = 0; j < bucket.size(); ++j)
+				keyFree(bucket[j].first);
+			bucket.clear(alloc());
+		}
+		mSize = 0;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned nb1, class allocatorT>
+	typename dictionary<T,nb1,allocatorT>::size_type dictionary<T,nb1,allocatorT>::find_batch
+		(const char * const * _keys, size_type _n, T** _results)
+	{
+		size_type hits = 0;
+		unsigned hashes[BatchGroupSize];
+		if(!mBuckets)
+		{
+			for(size_type i = 0; i < _n; ++i)
+				_results[i] = 0;
+			return 0;
+		}
+		// Migrate once, before resolving anything: moving slots later on would leave earlier results dangling
+		migrate(rehashStep());
+		for(size_type first = 0; first < _n; first += BatchGroupSize)
 		{
-			if(keyComp(iterator->first,_key))
+			const char * const * keys = &_keys[first];
+			unsigned groupSize = unsigned(_n - first < BatchGroupSize ? _n - first : BatchGroupSize);
+			// Hash the whole group and request every bucket header
+			for(unsigned i = 0; i < groupSize; ++i)
+			{
+				hashes[i] = hash(keys[i]);
+				prefetch(&bucketFor(hashes[i]));
+			}
+			// Request the slots of every bucket
+			for(unsigned i = 0; i < groupSize; ++i)
+				prefetch(bucketFor(hashes[i]).data());
+			// Request the key of each bucket's first slot, the one a lookup compares first, unless it is inline
+			for(unsigned i = 0; i < groupSize; ++i)
 			{
-				return iterator->second;
+				bucketT& bucket = bucketFor(hashes[i]);
+				if(!bucket.empty() && !bucket.front().first.is_inline())
+					prefetch(bucket.front().first.external());
+			}
+			// By now most of the group is in cache: resolve it
+			for(unsigned i = 0; i < groupSize; ++i)
+			{
+				slotT* slot = lookup(dictionary_key(keys[i]), hashes[i]);
+				_results[first + i] = slot ? &slot->second : 0;
+				hits += slot ? 1 : 0;
 			}
 		}
-		// Found nothing, create a new entry
+		return hits;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned nb1, class allocatorT>
+	typename dictionary<T,nb1,allocatorT>::size_type dictionary<T,nb1,allocatorT>::contains_batch
+		(const char * const * _keys, size_type _n, bool* _results)
+	{
+		size_type hits = 0;
+		T* values[BatchGroupSize];
+		for(size_type first = 0; first < _n; first += BatchGroupSize)
+		{
+			size_type groupSize = _n - first < BatchGroupSize ? _n - first : BatchGroupSize;
+			hits += find_batch(&_keys[first], groupSize, values);
+			for(size_type i = 0; i < groupSize; ++i)
+				_results[first + i] = 0 != values[i];
+		}
+		return hits;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned nb1, class allocatorT>
+	void dictionary<T,nb1,allocatorT>::incremental_rehash(bool _enable)
+	{
+		mIncremental = _enable;
+		if(!mIncremental && mOldBuckets)
+			migrate(mNumOldBuckets - mMigrated);
+	}
+
+#ifdef RTL_DICTIONARY_STATS
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned nb1, class allocatorT>
+	dictionary_stats dictionary<T,nb1,allocatorT>::stats() const
+	{
+		dictionary_stats result = mStats;
+		result.buckets = mNumBuckets + mNumOldBuckets;
+		result.empty_buckets = 0;
+		result.longest_bucket = 0;
+		for(size_type i = 0; mBuckets && i < mNumBuckets; ++i)
+		{
+			size_type bucketSize = isLive(i) ? mBuckets[i].size() : 0;
+			result.empty_buckets += 0 == bucketSize ? 1 : 0;
+			result.longest_bucket = bucketSize > result.longest_bucket ? bucketSize : result.longest_bucket;
+		}
+		for(size_type i = 0; i < mNumOldBuckets; ++i)
+		{
+			size_type bucketSize = mOldBuckets[i].size();
+			result.empty_buckets += 0 == bucketSize ? 1 : 0;
+			result.longest_bucket = bucketSize > result.longest_bucket ? bucketSize : result.longest_bucket;
+		}
+		return result;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned nb1, class allocatorT>
+	void dictionary<T,nb1,allocatorT>::reset_stats()
+	{
+		mStats.lookups = 0;
+		mStats.hits = 0;
+		mStats.misses = 0;
+		mStats.key_comparisons = 0;
+		for(unsigned i = 0; i <= dictionary_stats::MaxChainLength; ++i)
+			mStats.chain_length[i] = 0;
+	}
+#endif
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned nb1, class allocatorT>
+	typename dictionary<T,nb1,allocatorT>::slotT* dictionary<T,nb1,allocatorT>::lookup(const dictionary_key& _key, unsigned _hash,
+		bool _recordStats) const
+	{
+		// Slots compared: up to the one found, or the whole bucket
+		RTL_DICTIONARY_STAT(unsigned long long chainLength = 0);
+		slotT* slot = 0;
+		if(mBuckets)
+		{
+			bucketT& bucket = bucketFor(_hash);
+			slot = findSlot(bucket, _key);
+			RTL_DICTIONARY_STAT(chainLength = slot ? slot - bucket.data() + 1 : bucket.size());
+		}
+#ifdef RTL_DICTIONARY_STATS
+		if(_recordStats)
+		{
+			mStats.key_comparisons += chainLength;
+			++mStats.lookups;
+			++(slot ? mStats.hits : mStats.misses);
+			++mStats.chain_length[chainLength < dictionary_stats::MaxChainLength ? chainLength : dictionary_stats::MaxChainLength];
+		}
+#else
+		(void)_recordStats;
+#endif
+		return slot;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned nb1, class allocatorT>
+	typename dictionary<T,nb1,allocatorT>::slotT* dictionary<T,nb1,allocatorT>::findSlot(bucketT& _bucket, const dictionary_key& _key) const
+	{
+		size_type bucketSize = _bucket.size();
+		for(size_type i = 0; i < bucketSize; ++i)
+		{
+			if(keyComp(_bucket[i].first,_key))
+				return &_bucket[i];
+		}
+		return 0;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned nb1, class allocatorT>
+	T& dictionary<T,nb1,allocatorT>::insert(const dictionary_key& _key, unsigned _hash)
+	{
+		// The table is created on the first insertion, so empty dictionaries cost no memory beyond themselves
+		if(!mBuckets)
+			mBuckets = createTable(mNumBuckets);
+		else if(mSize >= mNumBuckets * max_load_factor())
+			grow();
 		// Create a new slot
-		slotT slot(0,T());
+		slotT slot((dictionary_key()), T());
 		keyCopy(slot.first, _key);
 		// Push it into the bucket
-		bucket.push_back(slot);
-		return slot.second;
+		bucketT& bucket = bucketFor(_hash);
+		bucket.push_back(slot, alloc());
+		++mSize;
+		return bucket.back().second;
 	}
 
 	//------------------------------------------------------------------------------------------------------------------
 	template<class T, unsigned nb1, class allocatorT>
-	bool dictionary<T,nb1,allocatorT>::contains(const char * _key)
+	typename dictionary<T,nb1,allocatorT>::bucketT& dictionary<T,nb1,allocatorT>::bucketFor(unsigned _hash) const
 	{
-		unsigned bucketId = hash(_key);
-		bucketT& bucket = mBuckets[bucketId];
-		for (bucketT::iterator i = 0; i != bucket.end(); ++i)
+		if(mOldBuckets)
 		{
-			if(keyComp(iterator->first,_key))
-			{
-				return true;
-			}
+			size_type oldId = _hash % mNumOldBuckets;
+			if(oldId >= mMigrated)
+				return mOldBuckets[oldId];
 		}
-		// Found nothing
-		return false;
+		return mBuckets[_hash % mNumBuckets];
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned nb1, class allocatorT>
+	void dictionary<T,nb1,allocatorT>::grow()
+	{
+		// rehashStep() has the previous migration over by now, unless the load factor was lowered meanwhile
+		if(mOldBuckets)
+			migrate(mNumOldBuckets - mMigrated);
+		mOldBuckets = mBuckets;
+		mNumOldBuckets = mNumBuckets;
+		mMigrated = 0;
+		mNumBuckets *= 2;
+		// Migrating old bucket i initializes new buckets i and i + mNumOldBuckets, the only ones its keys go to
+		mBuckets = createTable(mNumBuckets, false);
+		if(!mIncremental)
+			migrate(mNumOldBuckets);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Old buckets left to migrate, spread over the insertions left before the next growth
+	template<class T, unsigned nb1, class allocatorT>
+	typename dictionary<T,nb1,allocatorT>::size_type dictionary<T,nb1,allocatorT>::rehashStep() const
+	{
+		if(!mOldBuckets)
+			return 0;
+		size_type limit = mNumBuckets * max_load_factor();
+		size_type insertionsLeft = limit > mSize ? limit - mSize : 1;
+		size_type step = (mNumOldBuckets - mMigrated + insertionsLeft - 1) / insertionsLeft;
+		return step > RehashStep ? step : RehashStep;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned nb1, class allocatorT>
+	void dictionary<T,nb1,allocatorT>::migrate(size_type _nBuckets)
+	{
+		if(!mOldBuckets)
+			return;
+		size_type end = mMigrated + _nBuckets;
+		if(end > mNumOldBuckets)
+			end = mNumOldBuckets;
+		for(; mMigrated < end; ++mMigrated)
+		{
+			new(&mBuckets[mMigrated]) bucketT();
+			new(&mBuckets[mMigrated + mNumOldBuckets]) bucketT();
+			// Move the slots, keys are owned by whichever table holds them
+			bucketT& oldBucket = mOldBuckets[mMigrated];
+			for(size_type i = 0; i < oldBucket.size(); ++i)
+				mBuckets[hash(oldBucket[i].first.c_str()) % mNumBuckets].push_back(oldBucket[i], alloc());
+			oldBucket.clear(alloc());
+		}
+		if(mMigrated == mNumOldBuckets)
+		{
+			// Every bucket is empty by now, there is nothing to destroy
+			tableAllocT tableAlloc(alloc());
+			allocator_traits<tableAllocT>::deallocate(tableAlloc, mOldBuckets, mNumOldBuckets);
+			mOldBuckets = 0;
+			mNumOldBuckets = 0;
+			mMigrated = 0;
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned nb1, class allocatorT>
+	void dictionary<T,nb1,allocatorT>::initPendingBuckets()
+	{
+		for(size_type i = mMigrated; i < mNumOldBuckets; ++i)
+		{
+			new(&mBuckets[i]) bucketT();
+			new(&mBuckets[i + mNumOldBuckets]) bucketT();
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned nb1, class allocatorT>
+	void dictionary<T,nb1,allocatorT>::copyFrom(const dictionary<T,nb1,allocatorT>& x)
+	{
+		for(size_type i = 0; x.mBuckets && i < x.mNumBuckets; ++i)
+		{
+			if(!x.isLive(i))
+				continue;
+			const bucketT& bucket = x.mBuckets[i];
+			for(size_type j = 0; j < bucket.size(); ++j)
+				operator[](bucket[j].first.c_str()) = bucket[j].second;
+		}
+		for(size_type i = x.mMigrated; i < x.mNumOldBuckets; ++i)
+		{
+			const bucketT& bucket = x.mOldBuckets[i];
+			for(size_type j = 0; j < bucket.size(); ++j)
+				operator[](bucket[j].first.c_str()) = bucket[j].second;
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned nb1, class allocatorT>
+	typename dictionary<T,nb1,allocatorT>::bucketT* dictionary<T,nb1,allocatorT>::createTable(size_type _nBuckets,
+		bool _zeroed)
+	{
+		// An empty bucket is a null pointer, so a zeroed table is a table of empty buckets
+		static_assert(sizeof(bucketT) == sizeof(void*), "dictionary buckets must be a single pointer");
+		tableAllocT tableAlloc(alloc());
+		bucketT* table = allocator_traits<tableAllocT>::allocate(tableAlloc, _nBuckets);
+		if(_zeroed)
+			memset(static_cast<void*>(table), 0, _nBuckets * sizeof(bucketT));
+		return table;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Frees the keys held by a table, then the table itself. Migrated buckets are already empty.
+	template<class T, unsigned nb1, class allocatorT>
+	void dictionary<T,nb1,allocatorT>::destroyTable(bucketT* _table, size_type _nBuckets)
+	{
+		tableAllocT tableAlloc(alloc());
+		for(size_type i = 0; i < _nBuckets; ++i)
+		{
+			for(size_type j = 0; j < _table[i].size(); ++j)
+				keyFree(_table[i][j].first);
+			_table[i].clear(alloc());
+			tableAlloc.destroy(&_table[i]);
+		}
+		allocator_traits<tableAllocT>::deallocate(tableAlloc, _table, _nBuckets);
 	}
 
 	//------------------------------------------------------------------------------------------------------------------
@@ -178,37 +785,50 @@ namespace rtl
 			lHash += _key[i];
 			++i;
 		}
-		return lHash % nb;
+		return lHash;
 	}
 
 	//------------------------------------------------------------------------------------------------------------------
+	// Inline keys are copied as they are. Longer ones get their own copy, allocated with the dictionary's allocator.
 	template<class T, unsigned nb, class allocatorT>
-	bool dictionary<T,nb,allocatorT>::keyComp(const char * _a, const char * _b)
+	void dictionary<T,nb,allocatorT>::keyCopy(dictionary_key& _dst, const dictionary_key& _src)
 	{
-		if (!_a || !_b)
-			return false;
-		unsigned i = 0;
-		while(_a[i] != '\0' && _b[i] != '\0')
+		if(_src.is_inline())
 		{
-			if(_a[i] != _b[i])
-				return false;
+			_dst = _src;
+			return;
+		}
+		const char * src = _src.external();
+		unsigned i = 0;
+		while(src[i] != '\0')
 			++i;
+		keyAllocT keyAlloc(alloc());
+		char * dst = allocator_traits<keyAllocT>::allocate(keyAlloc, i+1);
+		dst[i] = '\0';
+		for(i = 0; src[i] != '\0'; ++i)
+		{
+			dst[i] = src[i];
 		}
-		return _a[i] == _b[i];
+		_dst.set_external(dst);
 	}
 
 	//------------------------------------------------------------------------------------------------------------------
+	// External keys are released with the length they were allocated with
 	template<class T, unsigned nb, class allocatorT>
-	void dictionary<T,nb,allocatorT>::keyCopy(char *& _dst, const char * _src)
+	void dictionary<T,nb,allocatorT>::keyFree(dictionary_key& _key)
 	{
-		for(unsigned i = 0; _src[i] != '\0'; ++i)
-			;
-		_dst = new char[i+1];
-		_dst[i] = '\0';
-		for(i = 0; _src[i] != '\0'; ++i)
-		{
-			_dst[i] = _src[i];
-		}
+		if(_key.is_inline())
+			return;
+		char * key = _key.external();
+		unsigned i = 0;
+		while(key[i] != '\0')
+			++i;
+		keyAllocT keyAlloc(alloc());
+		allocator_traits<keyAllocT>::deallocate(keyAlloc, key, i+1);
 	}
 
 }	// namespace rtl
+
+#undef RTL_DICTIONARY_STAT	// Only meant for this header
+
+#endif // _RTL_DICTIONARY_H_
@@ -0,0 +1,254 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Standard templates library. Freestanding implementation.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Dictionary bulk loading: builds dictionaries on several threads
+
+#ifndef _RTL_DICTIONARY_BULK_H_
+#define _RTL_DICTIONARY_BULK_H_
+
+#include <atomic>
+#include <thread>
+
+#include <dictionary.h>
+#include <utility.h>
+#include <vector.h>
+
+namespace rtl
+{
+	// Inserts _n keys with their values into _dict using up to _threads threads (0 means one per hardware thread).
+	// Keys already in the dictionary, and keys repeated in the input, end up with the value of their last occurrence.
+	// The table is sized for every key up front. Keys are hashed in parallel and partitioned by bucket ranges, so each
+	// partition is filled by a single thread with no locking, and every bucket grows to its final size once.
+	// The dictionary's allocator must be safe to use from several threads (rtl::allocator and caching_allocator are).
+	template<class T, unsigned NB, class allocatorT>
+	void bulk_load(dictionary<T,NB,allocatorT>& _dict, const char * const * _keys, const T* _values, size_t _n,
+		unsigned _threads = 0);
+	template<class T, unsigned NB, class allocatorT, class pairAllocT>
+	void bulk_load(dictionary<T,NB,allocatorT>& _dict, const vector<pair<const char*,T>,pairAllocT>& _pairs,
+		unsigned _threads = 0);
+
+	namespace detail
+	{
+		// Input adaptors, giving the keys and values of the i-th pair
+		template<class T>
+		struct bulk_arrays
+		{
+			const char*	key		(size_t _i) const	{ return keys[_i]; }
+			const T&	value	(size_t _i) const	{ return values[_i]; }
+
+			const char * const *	keys;
+			const T*				values;
+		};
+
+		template<class T>
+		struct bulk_pairs
+		{
+			const char*	key		(size_t _i) const	{ return pairs[_i].first; }
+			const T&	value	(size_t _i) const	{ return pairs[_i].second; }
+
+			const pair<const char*,T>*	pairs;
+		};
+
+		// Befriended by dictionary
+		template<class dictionaryT>
+		struct dictionary_bulk
+		{
+			typedef typename dictionaryT::size_type									size_type;
+			typedef typename dictionaryT::slotT										slotT;
+			typedef typename dictionaryT::bucketT									bucketT;
+			typedef typename dictionaryT::allocator_type							allocatorT;
+			typedef typename allocatorT::template rebind<unsigned>::other			hashAllocT;
+			typedef typename allocatorT::template rebind<size_type>::other			indexAllocT;
+			typedef typename allocatorT::template rebind<std::thread>::other		threadAllocT;
+
+			// Smaller loads aren't worth starting a thread for
+			static const size_type	MinKeysPerThread = 1 << 14;
+			// Partitions per thread. More partitions balance skewed tables better.
+			static const unsigned	PartitionsPerThread = 8;
+
+			template<class sourceT>
+			static void	load	(dictionaryT& _dict, const sourceT& _src, size_type _n, unsigned _threads);
+			// Makes the dictionary's table have at least _nBuckets buckets, with no rehash pending
+			static void	resize	(dictionaryT& _dict, size_type _nBuckets);
+			// Calls _f(t) for every t in [0, _threads), each on its own thread. The caller runs _f(0).
+			template<class functionT>
+			static void	parallel(unsigned _threads, const functionT& _f, const allocatorT& _alloc);
+		};
+
+		//--------------------------------------------------------------------------------------------------------------
+		template<class dictionaryT>
+		template<class sourceT>
+		void dictionary_bulk<dictionaryT>::load(dictionaryT& _dict, const sourceT& _src, size_type _n, unsigned _threads)
+		{
+			if(!_n)
+				return;
+			unsigned threads = _threads ? _threads : std::thread::hardware_concurrency();
+			size_type maxThreads = (_n + MinKeysPerThread - 1) / MinKeysPerThread;
+			if(!threads)
+				threads = 1;
+			if(threads > maxThreads)
+				threads = unsigned(maxThreads);
+
+			// Size the table for every key at once, doubling it as dictionary::grow would
+			size_type nBuckets = _dict.mNumBuckets;
+			while(_dict.mSize + _n > nBuckets * _dict.max_load_factor())
+				nBuckets *= 2;
+			resize(_dict, nBuckets);
+			bucketT* table = _dict.mBuckets;
+			nBuckets = _dict.mNumBuckets;
+
+			// Partition p owns the buckets b such that b * nParts / nBuckets == p, a contiguous range
+			size_type nParts = threads * PartitionsPerThread < nBuckets ? threads * PartitionsPerThread : nBuckets;
+			auto partitionOf = [=](unsigned _hash) {
+				return size_type((unsigned long long)(_hash % nBuckets) * nParts / nBuckets);
+			};
+			auto partitionBegin = [=](size_type _p) {
+				return size_type(((unsigned long long)_p * nBuckets + nParts - 1) / nParts);
+			};
+			// Thread t handles the input range [chunkBegin(t), chunkBegin(t+1)) in the first passes
+			auto chunkBegin = [=](unsigned _t) {
+				return size_type((unsigned long long)_n * _t / threads);
+			};
+
+			// Hash every key, counting how many of each thread's keys fall in each partition
+			vector<unsigned,hashAllocT> hashes(_n, 0, hashAllocT(_dict.alloc()));
+			vector<size_type,indexAllocT> next(threads * nParts, 0, indexAllocT(_dict.alloc()));
+			parallel(threads, [&](unsigned _t) {
+				size_type* count = &next[_t * nParts];
+				for(size_type i = chunkBegin(_t); i < chunkBegin(_t + 1); ++i)
+				{
+					hashes[i] = dictionaryT::hash(_src.key(i));
+					++count[partitionOf(hashes[i])];
+				}
+			}, _dict.alloc());
+
+			// Lay the partitions out one after another, each holding its keys in input order: threads' chunks follow
+			// each other. Counts become the position of every thread's next key in each partition.
+			vector<size_type,indexAllocT> partStart(nParts + 1, 0, indexAllocT(_dict.alloc()));
+			size_type pos = 0;
+			for(size_type p = 0; p < nParts; ++p)
+			{
+				partStart[p] = pos;
+				for(unsigned t = 0; t < threads; ++t)
+				{
+					size_type count = next[t * nParts + p];
+					next[t * nParts + p] = pos;
+					pos += count;
+				}
+			}
+			partStart[nParts] = pos;
+
+			vector<size_type,indexAllocT> order(_n, 0, indexAllocT(_dict.alloc()));
+			parallel(threads, [&](unsigned _t) {
+				size_type* partNext = &next[_t * nParts];
+				for(size_type i = chunkBegin(_t); i < chunkBegin(_t + 1); ++i)
+					order[partNext[partitionOf(hashes[i])]++] = i;
+			}, _dict.alloc());
+
+			// Fill the partitions. Whoever is free takes the next one.
+			std::atomic<size_type> nextPart(0);
+			std::atomic<size_type> inserted(0);
+			parallel(threads, [&](unsigned) {
+				allocatorT alloc(_dict.alloc());
+				vector<size_type,indexAllocT> bucketCount(alloc);
+				for(size_type p = nextPart++; p < nParts; p = nextPart++)
+				{
+					size_type firstBucket = partitionBegin(p);
+					bucketCount.clear();
+					bucketCount.resize(partitionBegin(p + 1) - firstBucket, 0);
+					for(size_type k = partStart[p]; k < partStart[p + 1]; ++k)
+						++bucketCount[hashes[order[k]] % nBuckets - firstBucket];
+					// Repeated keys make this an upper bound, which is good enough
+					for(size_type b = 0; b < bucketCount.size(); ++b)
+					{
+						bucketT& bucket = table[firstBucket + b];
+						if(bucketCount[b])
+							bucket.reserve(bucket.size() + bucketCount[b], alloc);
+					}
+					size_type added = 0;
+					for(size_type k = partStart[p]; k < partStart[p + 1]; ++k)
+					{
+						size_type i = order[k];
+						dictionary_key key(_src.key(i));
+						bucketT& bucket = table[hashes[i] % nBuckets];
+						// findSlot records no statistics, so threads can share it
+						slotT* found = _dict.findSlot(bucket, key);
+						if(found)
+						{
+							found->second = _src.value(i);
+							continue;
+						}
+						slotT slot(dictionary_key(), _src.value(i));
+						_dict.keyCopy(slot.first, key);
+						bucket.push_back(slot, alloc);
+						++added;
+					}
+					inserted += added;
+				}
+			}, _dict.alloc());
+			_dict.mSize += inserted;
+		}
+
+		//--------------------------------------------------------------------------------------------------------------
+		template<class dictionaryT>
+		void dictionary_bulk<dictionaryT>::resize(dictionaryT& _dict, size_type _nBuckets)
+		{
+			if(!_dict.mBuckets)
+			{
+				_dict.mNumBuckets = _nBuckets;
+				_dict.mBuckets = _dict.createTable(_nBuckets);
+				return;
+			}
+			_dict.migrate(_dict.mNumOldBuckets - _dict.mMigrated);
+			if(_nBuckets <= _dict.mNumBuckets)
+				return;
+			// Rehash the existing keys once, straight into the final table
+			_dict.mOldBuckets = _dict.mBuckets;
+			_dict.mNumOldBuckets = _dict.mNumBuckets;
+			_dict.mMigrated = 0;
+			_dict.mNumBuckets = _nBuckets;
+			_dict.mBuckets = _dict.createTable(_nBuckets);
+			_dict.migrate(_dict.mNumOldBuckets);
+		}
+
+		//--------------------------------------------------------------------------------------------------------------
+		template<class dictionaryT>
+		template<class functionT>
+		void dictionary_bulk<dictionaryT>::parallel(unsigned _threads, const functionT& _f, const allocatorT& _alloc)
+		{
+			// Threads can't be copied, which rtl::vector needs. Keep them in raw memory.
+			threadAllocT threadAlloc(_alloc);
+			std::thread* workers = _threads > 1 ? allocator_traits<threadAllocT>::allocate(threadAlloc, _threads - 1) : 0;
+			for(unsigned t = 1; t < _threads; ++t)
+				new(&workers[t - 1]) std::thread(_f, t);
+			_f(0);
+			for(unsigned t = 1; t < _threads; ++t)
+			{
+				workers[t - 1].join();
+				workers[t - 1].~thread();
+			}
+			if(workers)
+				allocator_traits<threadAllocT>::deallocate(threadAlloc, workers, _threads - 1);
+		}
+	}	// namespace detail
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned NB, class allocatorT>
+	void bulk_load(dictionary<T,NB,allocatorT>& _dict, const char * const * _keys, const T* _values, size_t _n,
+		unsigned _threads)
+	{
+		detail::bulk_arrays<T> source = { _keys, _values };
+		detail::dictionary_bulk<dictionary<T,NB,allocatorT>>::load(_dict, source, _n, _threads);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned NB, class allocatorT, class pairAllocT>
+	void bulk_load(dictionary<T,NB,allocatorT>& _dict, const vector<pair<const char*,T>,pairAllocT>& _pairs,
+		unsigned _threads)
+	{
+		detail::bulk_pairs<T> source = { _pairs.data() };
+		detail::dictionary_bulk<dictionary<T,NB,allocatorT>>::load(_dict, source, _pairs.size(), _threads);
+	}
+}	// namespace rtl
+
+#endif // _RTL_DICTIONARY_BULK_H_
@@ -0,0 +1,371 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Standard templates library. Freestanding implementation.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Buffered streams and stream iterators over file descriptors
+
+#ifndef _RTL_FD_STREAM_H_
+#define _RTL_FD_STREAM_H_
+
+#include <cstddef>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <io.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#else
+#include <cerrno>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#include <iterator_tags.h>
+#include <type_traits.h>
+#include <vector.h>
+
+namespace rtl
+{
+	namespace detail
+	{
+		// Largest transfer requested from the system at once. Both POSIX and Windows cap single transfers below 2 GB.
+		const size_t MaxIoSize = size_t(1) << 30;
+
+		// Raw transfers. Return the number of bytes transferred, 0 at end of file or a negative value on error.
+		inline ptrdiff_t fd_read(int _fd, void* _dst, size_t _bytes)
+		{
+			size_t bytes = _bytes < MaxIoSize ? _bytes : MaxIoSize;
+#if defined(_WIN32)
+			return _read(_fd, _dst, unsigned(bytes));
+#else
+			ptrdiff_t result;
+			do
+				result = ::read(_fd, _dst, bytes);
+			while(result < 0 && EINTR == errno);
+			return result;
+#endif
+		}
+
+		inline ptrdiff_t fd_write(int _fd, const void* _src, size_t _bytes)
+		{
+			size_t bytes = _bytes < MaxIoSize ? _bytes : MaxIoSize;
+#if defined(_WIN32)
+			return _write(_fd, _src, unsigned(bytes));
+#else
+			ptrdiff_t result;
+			do
+				result = ::write(_fd, _src, bytes);
+			while(result < 0 && EINTR == errno);
+			return result;
+#endif
+		}
+
+		// Bytes between the current offset and the end of a regular file. 0 for pipes, sockets, etc.
+		inline size_t fd_remaining(int _fd)
+		{
+#if defined(_WIN32)
+			struct _stat64 info;
+			if(0 != _fstat64(_fd, &info) || !(info.st_mode & _S_IFREG))
+				return 0;
+			long long offset = _lseeki64(_fd, 0, SEEK_CUR);
+#else
+			struct stat info;
+			if(0 != fstat(_fd, &info) || !S_ISREG(info.st_mode))
+				return 0;
+			long long offset = lseek(_fd, 0, SEEK_CUR);
+#endif
+			return (offset >= 0 && offset < info.st_size) ? size_t(info.st_size - offset) : 0;
+		}
+	}	// namespace detail
+
+	// ----- Buffered reader -----
+	// Reads a file descriptor through a buffer, so small reads (e.g. one record at a time) cost a memcpy instead of a
+	// system call. Reads at least as big as the buffer skip it and go straight to the destination.
+	// The descriptor is not owned: it is neither closed nor repositioned.
+	class fd_reader
+	{
+	public:
+		static const size_t DefaultBufferSize = 256 * 1024;
+
+		// A zero size buffer makes every read go straight to the descriptor
+		explicit fd_reader(int _fd, size_t _bufferSize = DefaultBufferSize)
+			:mFd(_fd)
+			,mBuffer(_bufferSize)
+			,mPos(0)
+			,mEnd(0)
+			,mEof(false)
+			,mError(false)
+		{}
+
+		// Copies up to _bytes into _dst. Returns less only at the end of the file or on errors.
+		size_t	read		(void* _dst, size_t _bytes);
+
+		// Bytes left: buffered ones plus the rest of the file. 0 when unknown.
+		size_t	remaining	() const	{ return (mEnd - mPos) + detail::fd_remaining(mFd); }
+		bool	eof			() const	{ return mEof && mPos == mEnd; }
+		bool	error		() const	{ return mError; }
+		int		fd			() const	{ return mFd; }
+
+	private:
+		fd_reader(const fd_reader&);
+		fd_reader& operator=(const fd_reader&);
+
+		// Reads into _dst straight from the descriptor. Returns the bytes read, which may be less than requested.
+		size_t	readSome	(void* _dst, size_t _bytes);
+
+	private:
+		int				mFd;
+		vector<char>	mBuffer;
+		size_t			mPos;	// Next buffered byte to read
+		size_t			mEnd;	// End of the buffered bytes
+		bool			mEof;
+		bool			mError;
+	};
+
+	//------------------------------------------------------------------------------------------------------------------
+	inline size_t fd_reader::read(void* _dst, size_t _bytes)
+	{
+		char* dst = static_cast<char*>(_dst);
+		size_t done = 0;
+		while(done < _bytes)
+		{
+			// Serve buffered bytes first
+			if(mPos != mEnd)
+			{
+				size_t n = mEnd - mPos < _bytes - done ? mEnd - mPos : _bytes - done;
+				memcpy(dst + done, &mBuffer[mPos], n);
+				mPos += n;
+				done += n;
+				continue;
+			}
+			if(mEof || mError)
+				break;
+			if(_bytes - done >= mBuffer.size())
+			{
+				// No point in buffering what fills the buffer anyway
+				done += readSome(dst + done, _bytes - done);
+			}
+			else
+			{
+				mPos = 0;
+				mEnd = readSome(mBuffer.data(), mBuffer.size());
+			}
+		}
+		return done;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	inline size_t fd_reader::readSome(void* _dst, size_t _bytes)
+	{
+		ptrdiff_t result = detail::fd_read(mFd, _dst, _bytes);
+		mEof = 0 == result;
+		mError = result < 0;
+		return result > 0 ? size_t(result) : 0;
+	}
+
+	// ----- Buffered writer -----
+	// Gathers small writes in a buffer and hands them to the system in big blocks. Writes at least as big as the buffer
+	// go straight to the descriptor. The destructor flushes. The descriptor is not owned.
+	class fd_writer
+	{
+	public:
+		static const size_t DefaultBufferSize = 256 * 1024;
+
+		explicit fd_writer(int _fd, size_t _bufferSize = DefaultBufferSize)
+			:mFd(_fd)
+			,mBuffer(_bufferSize)
+			,mUsed(0)
+			,mError(false)
+		{}
+		~fd_writer() { flush(); }
+
+		// Accepts _bytes from _src. Returns false if writing to the descriptor failed.
+		bool	write	(const void* _src, size_t _bytes);
+		bool	flush	();
+		bool	error	() const	{ return mError; }
+		int		fd		() const	{ return mFd; }
+
+	private:
+		fd_writer(const fd_writer&);
+		fd_writer& operator=(const fd_writer&);
+
+		// Writes all of [_src, _src + _bytes) to the descriptor
+		bool	writeAll	(const char* _src, size_t _bytes);
+
+	private:
+		int				mFd;
+		vector<char>	mBuffer;
+		size_t			mUsed;
+		bool			mError;
+	};
+
+	//------------------------------------------------------------------------------------------------------------------
+	inline bool fd_writer::write(const void* _src, size_t _bytes)
+	{
+		if(0 == _bytes)
+			return !mError;
+		if(_bytes <= mBuffer.size() - mUsed)
+		{
+			memcpy(&mBuffer[mUsed], _src, _bytes);
+			mUsed += _bytes;
+			return !mError;
+		}
+		if(!flush())
+			return false;
+		if(_bytes >= mBuffer.size())
+			return writeAll(static_cast<const char*>(_src), _bytes);
+		memcpy(mBuffer.data(), _src, _bytes);
+		mUsed = _bytes;
+		return true;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	inline bool fd_writer::flush()
+	{
+		bool ok = writeAll(mBuffer.data(), mUsed);
+		mUsed = 0;
+		return ok;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	inline bool fd_writer::writeAll(const char* _src, size_t _bytes)
+	{
+		while(_bytes && !mError)
+		{
+			ptrdiff_t result = detail::fd_write(mFd, _src, _bytes);
+			mError = result <= 0;
+			if(result > 0)
+			{
+				_src += result;
+				_bytes -= size_t(result);
+			}
+		}
+		return !mError;
+	}
+
+	// ----- Stream iterators -----
+	// Input iterator reading fixed size records of type T. A default constructed iterator is the end of the stream,
+	// which every other iterator reaches after the last complete record. A trailing partial record is dropped.
+	template<class T>
+	class fd_input_iterator
+	{
+	public:
+		typedef T					value_type;
+		typedef ptrdiff_t			difference_type;
+		typedef const T*			pointer;
+		typedef const T&			reference;
+		typedef input_iterator_tag	iterator_category;
+
+		fd_input_iterator			() : mReader(0) {}
+		explicit fd_input_iterator	(fd_reader& _reader) : mReader(&_reader) { readNext(); }
+
+		reference			operator*	() const	{ return mValue; }
+		pointer				operator->	() const	{ return &mValue; }
+		fd_input_iterator&	operator++	()			{ readNext(); return *this; }
+		fd_input_iterator	operator++	(int)		{ fd_input_iterator prev(*this); readNext(); return prev; }
+
+		// Iterators are equal when both are at the end of their streams, or both aren't and share one
+		bool				operator==	(const fd_input_iterator& x) const	{ return mReader == x.mReader; }
+
+	private:
+		static_assert(is_trivially_copyable<T>::value, "records must be trivially copyable");
+
+		void readNext()
+		{
+			if(mReader->read(&mValue, sizeof(T)) != sizeof(T))
+				mReader = 0;
+		}
+
+		fd_reader*	mReader;
+		T			mValue;
+	};
+
+	// Output iterator writing every record assigned to it
+	template<class T>
+	class fd_output_iterator
+	{
+	public:
+		typedef void				value_type;
+		typedef void				difference_type;
+		typedef void				pointer;
+		typedef void				reference;
+		typedef output_iterator_tag	iterator_category;
+
+		explicit fd_output_iterator	(fd_writer& _writer) : mWriter(&_writer) {}
+
+		fd_output_iterator&	operator=	(const T& _x)	{ mWriter->write(&_x, sizeof(T)); return *this; }
+		fd_output_iterator&	operator*	()		{ return *this; }
+		fd_output_iterator&	operator++	()		{ return *this; }
+		fd_output_iterator	operator++	(int)	{ return *this; }
+
+	private:
+		static_assert(is_trivially_copyable<T>::value, "records must be trivially copyable");
+
+		fd_writer*	mWriter;
+	};
+
+	// ----- Bulk transfers -----
+	namespace detail
+	{
+		// Producer for vector::append_uninitialized. Reads whole records into the vector's storage.
+		template<class T>
+		struct read_records
+		{
+			fd_reader* mReader;
+			size_t operator()(T* _dst, size_t _n) const { return mReader->read(_dst, _n * sizeof(T)) / sizeof(T); }
+		};
+	}	// namespace detail
+
+	// Appends the remaining records of a stream to a vector, reading them straight into its storage. When the size of
+	// the file is known, the vector grows once to hold it all. Returns the number of records read.
+	template<class T, class A>
+	size_t read_into(vector<T,A>& _v, fd_reader& _reader)
+	{
+		static_assert(is_trivially_copyable<T>::value, "records must be trivially copyable");
+		size_t first = _v.size();
+		_v.reserve(_v.size() + _reader.remaining() / sizeof(T));
+		detail::read_records<T> op = { &_reader };
+		for(;;)
+		{
+			size_t room = _v.capacity() - _v.size();
+			if(0 == room)
+			{
+				// Full, maybe at the end of the file. Read one more record before growing: push_back grows
+				// geometrically, and the following reads fill the new room at once.
+				T next;
+				if(_reader.read(&next, sizeof(T)) != sizeof(T))
+					break;
+				_v.push_back(next);
+				continue;
+			}
+			if(_v.append_uninitialized(room, op) < room)
+				break;
+		}
+		return _v.size() - first;
+	}
+
+	// Reads a whole descriptor without any intermediate buffer
+	template<class T, class A>
+	size_t read_into(vector<T,A>& _v, int _fd)
+	{
+		fd_reader reader(_fd, 0);
+		return read_into(_v, reader);
+	}
+
+	// Writes the records of a vector straight from its storage. Returns false on errors.
+	template<class T, class A>
+	bool write_from(const vector<T,A>& _v, fd_writer& _writer)
+	{
+		static_assert(is_trivially_copyable<T>::value, "records must be trivially copyable");
+		return _writer.write(_v.data(), _v.size() * sizeof(T));
+	}
+
+	template<class T, class A>
+	bool write_from(const vector<T,A>& _v, int _fd)
+	{
+		fd_writer writer(_fd, 0);
+		return write_from(_v, writer);
+	}
+}	// namespace rtl
+
+#endif // _RTL_FD_STREAM_H_
@@ -0,0 +1,302 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Standard templates library. Freestanding implementation.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Flat map: sorted associative array
+
+#ifndef _RTL_FLAT_MAP_H_
+#define _RTL_FLAT_MAP_H_
+
+#include <algorithm.h>
+#include <bitops.h>
+#include <memory.h>
+#include <utility.h>
+#include <vector.h>
+
+namespace rtl
+{
+	// Ordered map stored as a vector of pairs sorted by key. Keys only need operator<.
+	// Lookups are branchless binary searches over contiguous memory, which beats chained hashing for read-mostly maps
+	// of a few thousand entries. Insertion and erasure shift the tail of the array, so bulk loads should go through
+	// assign(), which sorts once.
+	// For large read-only maps, build_search_index() adds a copy of the keys in Eytzinger (breadth first) order. Searches
+	// over it touch one cache line per few tree levels and prefetch the next ones. Any modification drops the index.
+	template<class K, class V, class allocatorT = rtl::allocator<rtl::pair<K,V>>>
+	class flat_map
+	{
+	public:
+		// Public types
+		typedef K							key_type;
+		typedef V							mapped_type;
+		typedef rtl::pair<K,V>				value_type;
+		typedef value_type&					reference;
+		typedef const value_type&			const_reference;
+		typedef value_type*					iterator;
+		typedef const value_type*			const_iterator;
+		typedef	allocatorT					allocator_type;
+
+		typedef	typename rtl::allocator_traits<allocatorT>::size_type		size_type;
+		typedef typename rtl::allocator_traits<allocatorT>::difference_type	difference_type;
+
+		typedef rtl::vector<value_type,allocatorT>									storageT;
+		typedef rtl::vector<K,typename allocatorT::template rebind<K>::other>		layoutT;
+		typedef rtl::vector<size_type,typename allocatorT::template rebind<size_type>::other>	rankT;
+
+	public:
+		explicit flat_map(const allocatorT& _alloc = allocatorT());
+
+		allocator_type get_allocator() const { return mData.get_allocator(); }
+
+		// Bulk construction. Sorts the pairs by key, keeping the first one in input order out of every run of equal keys.
+		void			assign		(const value_type* _first, const value_type* _last);
+		void			assign		(const storageT& _pairs)	{ assign(_pairs.data(), _pairs.data() + _pairs.size()); }
+
+	public:
+		// Iterators
+		iterator		begin		()			{ return mData.data(); }
+		const_iterator	begin		() const	{ return mData.data(); }
+		iterator		end			()			{ return mData.data() + mData.size(); }
+		const_iterator	end			() const	{ return mData.data() + mData.size(); }
+
+		// Size and capacity
+		size_type		size		() const		{ return mData.size(); }
+		bool			empty		() const		{ return mData.empty(); }
+		void			reserve		(size_type n)	{ mData.reserve(n); }
+
+		// Lookup
+		iterator		find		(const K& _key);
+		const_iterator	find		(const K& _key) const;
+		bool			contains	(const K& _key) const	{ return end() != find(_key); }
+		V&				operator[]	(const K& _key);
+
+		// Range queries. Bounds are positions in the sorted sequence.
+		iterator		lower_bound	(const K& _key)			{ return begin() + rank(_key); }
+		const_iterator	lower_bound	(const K& _key) const	{ return begin() + rank(_key); }
+		iterator		upper_bound	(const K& _key);
+		const_iterator	upper_bound	(const K& _key) const;
+		// Pairs whose key lies in [_low, _high)
+		pair<iterator,iterator>				range	(const K& _low, const K& _high);
+		pair<const_iterator,const_iterator>	range	(const K& _low, const K& _high) const;
+
+		// Modifiers
+		pair<iterator,bool>	insert		(const value_type& _x);
+		size_type			erase		(const K& _key);
+		void				clear		();
+
+		// Eytzinger search index
+		void			build_search_index	();
+		bool			has_search_index	() const	{ return !mLayout.empty(); }
+
+	private:
+		// Orders pairs and keys by key alone
+		struct keyLess
+		{
+			bool operator()(const value_type& _a, const K& _b) const	{ return _a.first < _b; }
+			bool operator()(const K& _a, const value_type& _b) const	{ return _a < _b.first; }
+		};
+		struct pairKeyLess
+		{
+			bool operator()(const value_type& _a, const value_type& _b) const { return _a.first < _b.first; }
+		};
+		struct keyEqual
+		{
+			bool operator()(const value_type& _a, const value_type& _b) const { return !(_a.first < _b.first); }
+		};
+
+		size_type		rank			(const K& _key) const;	// Index of the first pair not less than _key
+		size_type		eytzingerRank	(const K& _key) const;
+		size_type		fillLayout		(size_type _node, size_type _rank);
+		void			dropSearchIndex	();
+
+	private:
+		storageT	mData;
+		layoutT		mLayout;	// 1-based Eytzinger ordered keys. Empty when there is no search index.
+		rankT		mRank;		// Position in mData of each key in mLayout
+	};
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Flat map implementation
+	//------------------------------------------------------------------------------------------------------------------
+	template<class K, class V, class allocatorT>
+	flat_map<K,V,allocatorT>::flat_map(const allocatorT& _alloc)
+		:mData(_alloc)
+		,mLayout(typename layoutT::allocator_type(_alloc))
+		,mRank(typename rankT::allocator_type(_alloc))
+	{
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class K, class V, class allocatorT>
+	void flat_map<K,V,allocatorT>::assign(const value_type* _first, const value_type* _last)
+	{
+		dropSearchIndex();
+		mData.clear();
+		mData.reserve(_last - _first);
+		for(; _first != _last; ++_first)
+			mData.push_back(*_first);
+		// A stable sort, so the first of several pairs with the same key in input order is the one unique keeps
+		storageT scratch(mData.get_allocator());
+		rtl::stable_sort(begin(), end(), scratch, pairKeyLess());
+		iterator newEnd = rtl::unique(begin(), end(), keyEqual());
+		mData.resize(newEnd - begin());
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class K, class V, class allocatorT>
+	typename flat_map<K,V,allocatorT>::iterator flat_map<K,V,allocatorT>::find(const K& _key)
+	{
+		iterator i = lower_bound(_key);
+		return (i != end() && !(_key < i->first)) ? i : end();
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class K, class V, class allocatorT>
+	typename flat_map<K,V,allocatorT>::const_iterator flat_map<K,V,allocatorT>::find(const K& _key) const
+	{
+		const_iterator i = lower_bound(_key);
+		return (i != end() && !(_key < i->first)) ? i : end();
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class K, class V, class allocatorT>
+	V& flat_map<K,V,allocatorT>::operator[](const K& _key)
+	{
+		return insert(value_type(_key, V())).first->second;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class K, class V, class allocatorT>
+	typename flat_map<K,V,allocatorT>::iterator flat_map<K,V,allocatorT>::upper_bound(const K& _key)
+	{
+		return rtl::upper_bound(begin(), end(), _key, keyLess());
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class K, class V, class allocatorT>
+	typename flat_map<K,V,allocatorT>::const_iterator flat_map<K,V,allocatorT>::upper_bound(const K& _key) const
+	{
+		return rtl::upper_bound(begin(), end(), _key, keyLess());
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class K, class V, class allocatorT>
+	pair<typename flat_map<K,V,allocatorT>::iterator, typename flat_map<K,V,allocatorT>::iterator>
+		flat_map<K,V,allocatorT>::range(const K& _low, const K& _high)
+	{
+		iterator first = lower_bound(_low);
+		iterator last = _high < _low ? first : lower_bound(_high);
+		return pair<iterator,iterator>(first, last);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class K, class V, class allocatorT>
+	pair<typename flat_map<K,V,allocatorT>::const_iterator, typename flat_map<K,V,allocatorT>::const_iterator>
+		flat_map<K,V,allocatorT>::range(const K& _low, const K& _high) const
+	{
+		const_iterator first = lower_bound(_low);
+		const_iterator last = _high < _low ? first : lower_bound(_high);
+		return pair<const_iterator,const_iterator>(first, last);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class K, class V, class allocatorT>
+	pair<typename flat_map<K,V,allocatorT>::iterator, bool> flat_map<K,V,allocatorT>::insert(const value_type& _x)
+	{
+		size_type pos = rank(_x.first);
+		if(pos != size() && !(_x.first < mData[pos].first))
+			return pair<iterator,bool>(begin() + pos, false);
+		dropSearchIndex();
+		// Append, then bubble the new pair down to its place
+		mData.push_back(_x);
+		for(size_type i = size() - 1; i > pos; --i)
+			rtl::swap(mData[i], mData[i-1]);
+		return pair<iterator,bool>(begin() + pos, true);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class K, class V, class allocatorT>
+	typename flat_map<K,V,allocatorT>::size_type flat_map<K,V,allocatorT>::erase(const K& _key)
+	{
+		iterator i = find(_key);
+		if(i == end())
+			return 0;
+		dropSearchIndex();
+		for(iterator last = end() - 1; i != last; ++i)
+			*i = *(i+1);
+		mData.pop_back();
+		return 1;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class K, class V, class allocatorT>
+	void flat_map<K,V,allocatorT>::clear()
+	{
+		dropSearchIndex();
+		mData.clear();
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class K, class V, class allocatorT>
+	void flat_map<K,V,allocatorT>::build_search_index()
+	{
+		dropSearchIndex();
+		if(empty())
+			return;
+		mLayout.resize(size() + 1);
+		mRank.resize(size() + 1);
+		fillLayout(1, 0);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class K, class V, class allocatorT>
+	typename flat_map<K,V,allocatorT>::size_type flat_map<K,V,allocatorT>::rank(const K& _key) const
+	{
+		if(has_search_index())
+			return eytzingerRank(_key);
+		return rtl::lower_bound(begin(), end(), _key, keyLess()) - begin();
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Descends the implicit tree, going right whenever the node is less than _key. The answer is the last node where we
+	// went left: undo the trailing right turns, plus that left turn.
+	template<class K, class V, class allocatorT>
+	typename flat_map<K,V,allocatorT>::size_type flat_map<K,V,allocatorT>::eytzingerRank(const K& _key) const
+	{
+		// Nodes 4 levels down from k start at 16k. Fetch them while comparing the levels in between.
+		const size_type prefetchDistance = 16;
+		const K* layout = mLayout.data();
+		size_type n = size();
+		size_type k = 1;
+		while(k <= n)
+		{
+			if(k * prefetchDistance <= n)
+				prefetch(&layout[k * prefetchDistance]);
+			k = 2 * k + (layout[k] < _key ? 1 : 0);
+		}
+		k >>= lowest_bit(~static_cast<unsigned long long>(k)) + 1;
+		return k ? mRank[k] : n;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// In-order traversal of the implicit tree rooted at _node, assigning sorted keys from _rank on. Returns the next rank.
+	template<class K, class V, class allocatorT>
+	typename flat_map<K,V,allocatorT>::size_type flat_map<K,V,allocatorT>::fillLayout(size_type _node, size_type _rank)
+	{
+		if(_node > size())
+			return _rank;
+		_rank = fillLayout(2 * _node, _rank);
+		mLayout[_node] = mData[_rank].first;
+		mRank[_node] = _rank;
+		return fillLayout(2 * _node + 1, _rank + 1);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class K, class V, class allocatorT>
+	void flat_map<K,V,allocatorT>::dropSearchIndex()
+	{
+		mLayout.clear();
+		mRank.clear();
+	}
+
+}	// namespace rtl
+
+#endif // _RTL_FLAT_MAP_H_
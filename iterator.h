@@ -8,10 +8,12 @@
 #define _RTL_ITERATOR_H_
 
 #include <cassert>
-#include <crtldef>
+#include <cstddef>
 
 #include <iterator_tags.h>
 #include <iterator_traits.h>
+#include <type_traits.h>
+#include <utility.h>
 
 namespace rtl
 {
@@ -31,85 +33,318 @@ namespace rtl
 		};
 
 	// ----- Operations on iterators ------
-	// Advance
-	template< class InputIterator, class Distance>
-		void advance ( InputIterator& i, Distance n )
+	namespace detail
+	{
+		template< class InputIterator, class Distance>
+		void advance ( InputIterator& i, Distance n, input_iterator_tag )
+		{
+			assert(n >= 0);
+			for(Distance d = 0; d < n; ++d)
+				++i;
+		}
+
+		template< class BidirectionalIterator, class Distance>
+		void advance ( BidirectionalIterator& i, Distance n, bidirectional_iterator_tag )
 		{
-			if(typename iterator_traits<InputIterator>::iterator_category == random_access_iterator_tag)
+			if(n >= 0)
 			{
-				i = i+n;
+				for(Distance d = 0; d < n; ++d)
+					++i;
 			}
 			else
 			{
-				if(typename iterator_traits<InputIterator>::iterator_category != bidirectional_iterator_tag)
-				{
-					assert(n >= 0);
-					for(Distance d = 0; d < n; ++d)
-						++i;
-				}
-				else
-				{
-					if(n >= 0)
-					{
-						for(Distance d = 0; d < n; ++d)
-							++i;
-					}
-					else
-					{
-						for(Distance d = 0; d > n; --d)
-							--i;
-					}
-				}
+				for(Distance d = 0; d > n; --d)
+					--i;
 			}
 		}
 
-	// Distance
-	template< class InputIterator >
-	typename iterator_traits<InputIterator>::difference_type
-		distance( InputIterator& first, InputIterator& last )
-	{
-		if(typename rtl::iterator_traits<InputIterator>::iterator_category == rtl::random_access_iterator_tag)
+		template< class RandomAccessIterator, class Distance>
+		void advance ( RandomAccessIterator& i, Distance n, random_access_iterator_tag )
 		{
-			return last - first;
+			i += n;
 		}
-		else
+
+		template< class InputIterator >
+		typename iterator_traits<InputIterator>::difference_type
+			distance( InputIterator first, InputIterator last, input_iterator_tag )
 		{
-			typename rtl::iterator_traits<InputIterator>::difference_type d = 0;
-			InputIterator i = first;
-			while(i != last)
-			{
+			typename iterator_traits<InputIterator>::difference_type d = 0;
+			for(; first != last; ++first)
 				++d;
-				++i;
-			}
 			return d;
 		}
+
+		template< class RandomAccessIterator >
+		typename iterator_traits<RandomAccessIterator>::difference_type
+			distance( RandomAccessIterator first, RandomAccessIterator last, random_access_iterator_tag )
+		{
+			return last - first;
+		}
+	}	// namespace detail
+
+	// Advance
+	template< class InputIterator, class Distance>
+	inline void advance ( InputIterator& i, Distance n )
+	{
+		detail::advance(i, n, typename iterator_traits<InputIterator>::iterator_category());
+	}
+
+	// Distance
+	template< class InputIterator >
+	inline typename iterator_traits<InputIterator>::difference_type
+		distance( InputIterator first, InputIterator last )
+	{
+		return detail::distance(first, last, typename iterator_traits<InputIterator>::iterator_category());
 	}
 
 	// Next
 	template < class ForwardIterator >
-	ForwardIterator next ( ForwardIterator& i,
-		typename rtl::iterator_traits<ForwardIterator>::difference_type n )
+	ForwardIterator next ( ForwardIterator i,
+		typename rtl::iterator_traits<ForwardIterator>::difference_type n = 1 )
 	{
-		advance( i , n );
+		rtl::advance( i , n );
 		return i;
 	}
 
 	// Prev
 	template < class BidirectionalIterator >
-	BidirectionalIterator prev ( BidirectionalIterator& i,
-		typename rtl::iterator_traits<BidirectionalIterator>::difference_type n )
+	BidirectionalIterator prev ( BidirectionalIterator i,
+		typename rtl::iterator_traits<BidirectionalIterator>::difference_type n = 1 )
 	{
-		advance( i, -n );
+		rtl::advance( i, -n );
 		return i;
 	}
 
 	// ----- Iterator adaptators -----
-	// TODO: Reverse iterator
-	// TODO: Insert iterator
-	// TODO: Move iterator
+	// Reverse iterator. Keeps an iterator to the element after the one it refers to, so rbegin() is built from end().
+	// Reversing a contiguous range gives a random access one.
+	namespace detail
+	{
+		template< class Category >	struct reverse_category							{ typedef Category type; };
+		template< >					struct reverse_category<contiguous_iterator_tag>	{ typedef random_access_iterator_tag type; };
+	}	// namespace detail
+
+	template < class Iterator >
+	class reverse_iterator
+	{
+	public:
+		typedef Iterator														iterator_type;
+		typedef typename iterator_traits<Iterator>::value_type					value_type;
+		typedef typename iterator_traits<Iterator>::difference_type				difference_type;
+		typedef typename iterator_traits<Iterator>::pointer						pointer;
+		typedef typename iterator_traits<Iterator>::reference					reference;
+		typedef typename detail::reverse_category<
+			typename iterator_traits<Iterator>::iterator_category>::type		iterator_category;
+
+		reverse_iterator			() : mCurrent() {}
+		explicit reverse_iterator	(Iterator x) : mCurrent(x) {}
+		template< class U >
+		reverse_iterator			(const reverse_iterator<U>& x) : mCurrent(x.base()) {}
+
+		Iterator			base		() const { return mCurrent; }
+
+		reference			operator*	() const { Iterator i = mCurrent; return *--i; }
+		pointer				operator->	() const { return &operator*(); }
+		reference			operator[]	(difference_type n) const { return *(*this + n); }
+
+		reverse_iterator&	operator++	()		{ --mCurrent; return *this; }
+		reverse_iterator	operator++	(int)	{ reverse_iterator prev(*this); --mCurrent; return prev; }
+		reverse_iterator&	operator--	()		{ ++mCurrent; return *this; }
+		reverse_iterator	operator--	(int)	{ reverse_iterator prev(*this); ++mCurrent; return prev; }
+
+		reverse_iterator&	operator+=	(difference_type n)			{ mCurrent -= n; return *this; }
+		reverse_iterator&	operator-=	(difference_type n)			{ mCurrent += n; return *this; }
+		reverse_iterator	operator+	(difference_type n) const	{ return reverse_iterator(mCurrent - n); }
+		reverse_iterator	operator-	(difference_type n) const	{ return reverse_iterator(mCurrent + n); }
+		difference_type		operator-	(const reverse_iterator& x) const	{ return x.mCurrent - mCurrent; }
+
+		bool				operator==	(const reverse_iterator& x) const	{ return mCurrent == x.mCurrent; }
+		bool				operator<	(const reverse_iterator& x) const	{ return x.mCurrent < mCurrent; }
+
+	protected:
+		Iterator mCurrent;
+	};
+
+	template < class Iterator >
+	inline reverse_iterator<Iterator> make_reverse_iterator( Iterator i )
+	{
+		return reverse_iterator<Iterator>(i);
+	}
+
+	// Insert iterators. Output iterators that add every element assigned to them to a container.
+	template < class Container >
+	class back_insert_iterator
+	{
+	public:
+		typedef Container			container_type;
+		typedef void				value_type;
+		typedef void				difference_type;
+		typedef void				pointer;
+		typedef void				reference;
+		typedef output_iterator_tag	iterator_category;
+
+		explicit back_insert_iterator	(Container& c) : mContainer(&c) {}
+
+		back_insert_iterator&	operator=	(const typename Container::value_type& x)	{ mContainer->push_back(x); return *this; }
+		back_insert_iterator&	operator=	(typename Container::value_type&& x)		{ mContainer->push_back(rtl::move(x)); return *this; }
+
+		back_insert_iterator&	operator*	()		{ return *this; }
+		back_insert_iterator&	operator++	()		{ return *this; }
+		back_insert_iterator	operator++	(int)	{ return *this; }
+
+		// The container being appended to. Bulk algorithms use it to insert whole ranges at once.
+		Container&				container	() const	{ return *mContainer; }
+
+	protected:
+		Container* mContainer;
+	};
+
+	template < class Container >
+	class front_insert_iterator
+	{
+	public:
+		typedef Container			container_type;
+		typedef void				value_type;
+		typedef void				difference_type;
+		typedef void				pointer;
+		typedef void				reference;
+		typedef output_iterator_tag	iterator_category;
+
+		explicit front_insert_iterator	(Container& c) : mContainer(&c) {}
+
+		front_insert_iterator&	operator=	(const typename Container::value_type& x)	{ mContainer->push_front(x); return *this; }
+		front_insert_iterator&	operator=	(typename Container::value_type&& x)		{ mContainer->push_front(rtl::move(x)); return *this; }
+
+		front_insert_iterator&	operator*	()		{ return *this; }
+		front_insert_iterator&	operator++	()		{ return *this; }
+		front_insert_iterator	operator++	(int)	{ return *this; }
+
+	protected:
+		Container* mContainer;
+	};
+
+	// Inserts before a fixed position, so consecutive assignments keep their order
+	template < class Container >
+	class insert_iterator
+	{
+	public:
+		typedef Container			container_type;
+		typedef void				value_type;
+		typedef void				difference_type;
+		typedef void				pointer;
+		typedef void				reference;
+		typedef output_iterator_tag	iterator_category;
+
+		insert_iterator	(Container& c, typename Container::iterator i) : mContainer(&c), mIter(i) {}
+
+		insert_iterator&	operator=	(const typename Container::value_type& x)
+		{
+			mIter = mContainer->insert(mIter, x);
+			++mIter;
+			return *this;
+		}
+		insert_iterator&	operator=	(typename Container::value_type&& x)
+		{
+			mIter = mContainer->insert(mIter, rtl::move(x));
+			++mIter;
+			return *this;
+		}
+
+		insert_iterator&	operator*	()		{ return *this; }
+		insert_iterator&	operator++	()		{ return *this; }
+		insert_iterator&	operator++	(int)	{ return *this; }
+
+	protected:
+		Container*						mContainer;
+		typename Container::iterator	mIter;
+	};
+
+	template < class Container >
+	inline back_insert_iterator<Container> back_inserter( Container& c )
+	{
+		return back_insert_iterator<Container>(c);
+	}
+
+	template < class Container >
+	inline front_insert_iterator<Container> front_inserter( Container& c )
+	{
+		return front_insert_iterator<Container>(c);
+	}
+
+	template < class Container >
+	inline insert_iterator<Container> inserter( Container& c, typename Container::iterator i )
+	{
+		return insert_iterator<Container>(c, i);
+	}
+
+	// Move iterator. Dereferences to rvalues, so the elements it reads are moved from instead of copied. Iterators that
+	// already return values (e.g. computed elements) are passed through, a reference to their result would dangle.
+	// It has the category of the underlying iterator: containers recognize contiguous moved ranges and transfer
+	// trivially copyable elements in bulk.
+	template < class Iterator >
+	class move_iterator
+	{
+	public:
+		typedef Iterator												iterator_type;
+		typedef typename iterator_traits<Iterator>::value_type			value_type;
+		typedef typename iterator_traits<Iterator>::difference_type		difference_type;
+		typedef Iterator												pointer;
+		typedef typename conditional<is_lvalue_reference<typename iterator_traits<Iterator>::reference>::value,
+			typename remove_reference<typename iterator_traits<Iterator>::reference>::type&&,
+			typename iterator_traits<Iterator>::reference>::type		reference;
+		typedef typename iterator_traits<Iterator>::iterator_category	iterator_category;
+
+		move_iterator			() : mCurrent() {}
+		explicit move_iterator	(Iterator i) : mCurrent(i) {}
+		template< class U >
+		move_iterator			(const move_iterator<U>& x) : mCurrent(x.base()) {}
+
+		Iterator			base		() const { return mCurrent; }
+
+		reference			operator*	() const { return static_cast<reference>(*mCurrent); }
+		pointer				operator->	() const { return mCurrent; }
+		reference			operator[]	(difference_type n) const { return static_cast<reference>(mCurrent[n]); }
+
+		move_iterator&		operator++	()		{ ++mCurrent; return *this; }
+		move_iterator		operator++	(int)	{ move_iterator prev(*this); ++mCurrent; return prev; }
+		move_iterator&		operator--	()		{ --mCurrent; return *this; }
+		move_iterator		operator--	(int)	{ move_iterator prev(*this); --mCurrent; return prev; }
+
+		move_iterator&		operator+=	(difference_type n)			{ mCurrent += n; return *this; }
+		move_iterator&		operator-=	(difference_type n)			{ mCurrent -= n; return *this; }
+		move_iterator		operator+	(difference_type n) const	{ return move_iterator(mCurrent + n); }
+		move_iterator		operator-	(difference_type n) const	{ return move_iterator(mCurrent - n); }
+		difference_type		operator-	(const move_iterator& x) const	{ return mCurrent - x.mCurrent; }
+
+		bool				operator==	(const move_iterator& x) const	{ return mCurrent == x.mCurrent; }
+		bool				operator<	(const move_iterator& x) const	{ return mCurrent < x.mCurrent; }
+
+	protected:
+		Iterator mCurrent;
+	};
+
+	template < class Iterator >
+	inline move_iterator<Iterator> make_move_iterator( Iterator i )
+	{
+		return move_iterator<Iterator>(i);
+	}
+
+	// Strips a move adaptor. Moving a trivially copyable object is copying it, so bulk transfers of such elements can
+	// read the underlying range directly.
+	template < class Iterator >
+	inline Iterator unwrap_move( Iterator i )
+	{
+		return i;
+	}
+
+	template < class Iterator >
+	inline Iterator unwrap_move( move_iterator<Iterator> i )
+	{
+		return i.base();
+	}
 
 	// ----- Iterator streams -----
-	// TODO: all
+	// Iterators over file descriptors are declared in fd_stream.h
 
 
 }	// namespace rtl
@@ -14,6 +14,9 @@ namespace rtl
 	struct forward_iterator_tag: public input_iterator_tag { };
 	struct bidirectional_iterator_tag: public forward_iterator_tag { };
 	struct random_access_iterator_tag: public bidirectional_iterator_tag { };
+	// Random access iterators over elements stored at consecutive addresses, like pointers. Ranges of them can be
+	// copied in bulk.
+	struct contiguous_iterator_tag: public random_access_iterator_tag { };
 }	// namespace rtl
 
 #endif // _RTL_ITERATOR_TAGS_H_
@@ -7,9 +7,10 @@
 #ifndef _RTL_ITERATOR_TRAITS_H_
 #define _RTL_ITERATOR_TRAITS_H_
 
-#include <crtldef>
+#include <cstddef>
 
 #include <iterator_tags.h>
+#include <type_traits.h>
 
 namespace rtl
 {	
@@ -31,7 +32,7 @@ namespace rtl
 		typedef ptrdiff_t					difference_type;
 		typedef _t*							pointer;
 		typedef _t&							reference;
-		typedef random_access_iterator_tag	iterator_category;
+		typedef contiguous_iterator_tag		iterator_category;
 	};
 
 	// iterator_traits specialization for pointers to const
@@ -40,10 +41,15 @@ namespace rtl
 	{
 		typedef _t							value_type;
 		typedef ptrdiff_t					difference_type;
-		typedef _t*							pointer;
-		typedef _t&							reference;
-		typedef random_access_iterator_tag	iterator_category;
+		typedef const _t*					pointer;
+		typedef const _t&					reference;
+		typedef contiguous_iterator_tag		iterator_category;
 	};
+
+	// True for iterators whose ranges are contiguous blocks of memory
+	template< class _t >
+	struct is_contiguous_iterator
+		: is_base_of<contiguous_iterator_tag, typename iterator_traits<_t>::iterator_category> {};
 }	// namespace rtl
 
 #endif // _RTL_ITERATOR_TRAITS_H_
@@ -10,6 +10,19 @@
 #include <new>
 #include <numeric>
 
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <xmmintrin.h>	// _mm_prefetch
+#endif
+
+// Define RTL_PROFILING before including rtl headers to measure allocator::allocate, vector::reallocate and
+// dictionary::find with hardware counters, reported through rtl::perf_sites (see perf_counters.h). When it is not
+// defined, the hooks compile to nothing.
+#ifdef RTL_PROFILING
+#include <perf_counters.h>
+#else
+#define RTL_PROFILE(site)
+#endif
+
 namespace rtl
 {
 	template <class Alloc>
@@ -48,7 +61,12 @@ namespace rtl
 		typedef void*		void_pointer;
 		typedef const void*	const_void_pointer;
 
+		template<class U>
+		struct rebind { typedef allocator<U> other; };
+
 		allocator();
+		template<class U>
+		allocator(const allocator<U>&) {}
 		allocator(const allocator&);
 		~allocator();
 
@@ -60,6 +78,7 @@ namespace rtl
 		size_type		max_size	() const;
 
 		void			construct	(pointer _p, const_reference _x = T());
+		void			construct	(pointer _p, T&& _x);
 		void			destroy		(pointer _p );
 	};
 
@@ -100,6 +119,7 @@ namespace rtl
 	typename allocator<T>::pointer allocator<T>::allocate(typename allocator<T>::size_type size, const void * hint)
 	{
 		hint; // Unused variable
+		RTL_PROFILE(allocator_allocate);
 		return reinterpret_cast<pointer>(new char[size * sizeof(T)]);
 	}
 
@@ -126,12 +146,32 @@ namespace rtl
 		new (_pAllocatedMemory)T(_argument); // Placement new of T
 	}
 
+	//------------------------------------------------------------------------
+	template<class T>
+	void allocator<T>::construct( typename allocator<T>::pointer _pAllocatedMemory, T&& _argument)
+	{
+		new (_pAllocatedMemory)T(static_cast<T&&>(_argument)); // Placement new of T, moving _argument
+	}
+
 	//------------------------------------------------------------------------
 	template<class T>
 	void allocator<T>::destroy(typename allocator<T>::pointer _object)
 	{
 		_object->~T(); // Call object's destructor, but do not deallocate memory
 	}
+
+	// ---------------- Cache hints ---------------
+	// Hint the processor to bring the cache line containing _p closer. Never faults, even on invalid addresses.
+	inline void prefetch(const void * _p)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		__builtin_prefetch(_p);
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+		_mm_prefetch(reinterpret_cast<const char*>(_p), _MM_HINT_T0);
+#else
+		_p; // Unused variable
+#endif
+	}
 }	// namespace rtl
 
 #endif // _RTL_MEMORY_H_
@@ -0,0 +1,297 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Standard templates library. Freestanding implementation.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Performance counters: hardware event counts of code regions
+
+#ifndef _RTL_PERF_COUNTERS_H_
+#define _RTL_PERF_COUNTERS_H_
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace rtl
+{
+	enum perf_event
+	{
+		perf_cycles,
+		perf_instructions,
+		perf_l1d_misses,	// L1 data cache read misses
+		perf_llc_misses,	// Last level cache misses
+		perf_branch_misses,
+		perf_dtlb_misses,	// Data TLB read misses
+		perf_event_count
+	};
+
+	// Counter values at some point, or accumulated over regions
+	struct perf_sample
+	{
+		unsigned long long	nanoseconds;	// Wall clock
+		// Time the counters were enabled and actually counting. They differ when the kernel multiplexes more events
+		// than the hardware can count at once.
+		unsigned long long	enabled;
+		unsigned long long	running;
+		unsigned long long	events[perf_event_count];
+	};
+
+	// Hardware counters of the calling thread, counting user space only. They are read through Linux perf_event_open.
+	// Events the kernel refuses (perf_event_paranoid, virtual machines without a PMU, other systems) are unavailable
+	// and read as zero, so in the worst case samples only hold the time.
+	class perf_counters
+	{
+	public:
+		perf_counters();
+		~perf_counters();
+
+		// Counters of the calling thread, opened on first use
+		static perf_counters&	thread	();
+		static const char *		name	(perf_event _event);
+
+		bool	available		(perf_event _event) const	{ return mSlot[_event] >= 0; }
+		bool	any_available	() const					{ return mLeader >= 0; }
+		void	read			(perf_sample& _sample) const;
+
+	private:
+		perf_counters(const perf_counters&);
+		perf_counters& operator=(const perf_counters&);
+
+	private:
+		int			mLeader;	// All events are read at once through the group leader. -1 if there is none.
+		int			mFds[perf_event_count];
+		int			mSlot[perf_event_count];	// Position of each event in a group read, -1 if it is unavailable
+	};
+
+	// Accumulated samples of a profiled operation
+	struct perf_totals
+	{
+		explicit perf_totals(const char * _name) : name(_name) { reset(); }
+
+		void	add		(const perf_sample& _begin, const perf_sample& _end);
+		void	reset	();
+		// Writes the averages per call to _fd. Counts are scaled up by the time they were multiplexed out.
+		void	report	(int _fd = 2) const;
+
+		const char *		name;
+		unsigned long long	calls;
+		perf_sample			sum;
+	};
+
+	// Adds the time and events between its construction and destruction to a perf_totals. Regions include whatever
+	// regions are nested in them, reads of the counters included. Totals are plain integers: they are only accurate
+	// while one thread at a time updates them.
+	class perf_region
+	{
+	public:
+		explicit perf_region(perf_totals& _totals) : mTotals(_totals), mCounters(perf_counters::thread())
+		{
+			mCounters.read(mBegin);
+		}
+		~perf_region()
+		{
+			perf_sample end;
+			mCounters.read(end);
+			mTotals.add(mBegin, end);
+		}
+
+	private:
+		perf_region(const perf_region&);
+		perf_region& operator=(const perf_region&);
+
+	private:
+		perf_totals&	mTotals;
+		perf_counters&	mCounters;
+		perf_sample		mBegin;
+	};
+
+	// Operations instrumented when RTL_PROFILING is defined
+	namespace perf_sites
+	{
+		inline perf_totals& allocator_allocate	() { static perf_totals totals("allocator::allocate"); return totals; }
+		inline perf_totals& vector_reallocate	() { static perf_totals totals("vector::reallocate"); return totals; }
+		inline perf_totals& dictionary_find		() { static perf_totals totals("dictionary::find"); return totals; }
+
+		inline void report(int _fd = 2)
+		{
+			allocator_allocate().report(_fd);
+			vector_reallocate().report(_fd);
+			dictionary_find().report(_fd);
+		}
+
+		inline void reset()
+		{
+			allocator_allocate().reset();
+			vector_reallocate().reset();
+			dictionary_find().reset();
+		}
+	}	// namespace perf_sites
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Perf counters implementation
+	//------------------------------------------------------------------------------------------------------------------
+	inline perf_counters::perf_counters()
+		:mLeader(-1)
+	{
+		for(unsigned e = 0; e < perf_event_count; ++e)
+		{
+			mFds[e] = -1;
+			mSlot[e] = -1;
+		}
+#if defined(__linux__)
+		static const struct { unsigned type; unsigned long long config; } events[perf_event_count] =
+		{
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+			{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+			{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+		};
+		int numOpen = 0;
+		for(unsigned e = 0; e < perf_event_count; ++e)
+		{
+			perf_event_attr attr;
+			memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = events[e].type;
+			attr.config = events[e].config;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			// The leader starts disabled, so the whole group is enabled at once
+			attr.disabled = mLeader < 0 ? 1 : 0;
+			int fd = int(syscall(__NR_perf_event_open, &attr, 0, -1, mLeader, 0));
+			if(fd < 0)
+				continue;
+			if(mLeader < 0)
+				mLeader = fd;
+			mFds[e] = fd;
+			mSlot[e] = numOpen++;
+		}
+		if(mLeader >= 0)
+			ioctl(mLeader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	inline perf_counters::~perf_counters()
+	{
+#if defined(__linux__)
+		// Members first, then the leader
+		for(unsigned e = perf_event_count; e > 0; --e)
+		{
+			if(mFds[e-1] >= 0)
+				close(mFds[e-1]);
+		}
+#endif
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	inline perf_counters& perf_counters::thread()
+	{
+		static thread_local perf_counters counters;
+		return counters;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	inline const char * perf_counters::name(perf_event _event)
+	{
+		static const char * const names[perf_event_count] =
+		{
+			"cycles", "instructions", "l1d-misses", "llc-misses", "branch-misses", "dtlb-misses"
+		};
+		return names[_event];
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	inline void perf_counters::read(perf_sample& _sample) const
+	{
+		memset(&_sample, 0, sizeof(_sample));
+#if defined(__linux__)
+		if(mLeader >= 0)
+		{
+			// Group read: number of events, time enabled, time running, then the values in opening order
+			unsigned long long buffer[3 + perf_event_count];
+			if(::read(mLeader, buffer, sizeof(buffer)) >= ssize_t(3 * sizeof(buffer[0])))
+			{
+				_sample.enabled = buffer[1];
+				_sample.running = buffer[2];
+				for(unsigned e = 0; e < perf_event_count; ++e)
+				{
+					if(mSlot[e] >= 0)
+						_sample.events[e] = buffer[3 + mSlot[e]];
+				}
+			}
+		}
+#endif
+		// After the counters, so the time doesn't include reading them
+		_sample.nanoseconds = static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Perf totals implementation
+	//------------------------------------------------------------------------------------------------------------------
+	inline void perf_totals::add(const perf_sample& _begin, const perf_sample& _end)
+	{
+		++calls;
+		sum.nanoseconds += _end.nanoseconds - _begin.nanoseconds;
+		sum.enabled += _end.enabled - _begin.enabled;
+		sum.running += _end.running - _begin.running;
+		for(unsigned e = 0; e < perf_event_count; ++e)
+			sum.events[e] += _end.events[e] - _begin.events[e];
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	inline void perf_totals::reset()
+	{
+		calls = 0;
+		memset(&sum, 0, sizeof(sum));
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	inline void perf_totals::report(int _fd) const
+	{
+		char line[512];
+		double perCall = calls ? 1.0 / calls : 0.0;
+		int length = snprintf(line, sizeof(line), "%-20s %12llu calls %10.1f ns", name, calls, sum.nanoseconds * perCall);
+		const perf_counters& counters = perf_counters::thread();
+		double scale = sum.running ? double(sum.enabled) / sum.running : 0.0;
+		for(unsigned e = 0; e < perf_event_count && length < int(sizeof(line)); ++e)
+		{
+			if(counters.available(perf_event(e)))
+				length += snprintf(line + length, sizeof(line) - length, " %10.2f %s", sum.events[e] * scale * perCall,
+					perf_counters::name(perf_event(e)));
+		}
+		if(length < int(sizeof(line)) && counters.available(perf_cycles) && counters.available(perf_instructions)
+			&& sum.events[perf_cycles])
+			length += snprintf(line + length, sizeof(line) - length, " %6.2f ipc",
+				double(sum.events[perf_instructions]) / sum.events[perf_cycles]);
+		if(length >= int(sizeof(line)))
+			length = int(sizeof(line)) - 1;
+		line[length++] = '\n';
+#if defined(_WIN32)
+		_write(_fd, line, unsigned(length));
+#else
+		ssize_t written = ::write(_fd, line, size_t(length));
+		(void)written;
+#endif
+	}
+}	// namespace rtl
+
+// Hooks of the instrumented operations. Define RTL_PROFILING before including any rtl header to enable them.
+#ifdef RTL_PROFILING
+#define RTL_PROFILE(site) rtl::perf_region rtlProfiledRegion(rtl::perf_sites::site())
+#endif
+
+#endif // _RTL_PERF_COUNTERS_H_
@@ -0,0 +1,747 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Standard templates library. Freestanding implementation.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Lazy range views
+
+#ifndef _RTL_RANGES_H_
+#define _RTL_RANGES_H_
+
+#include <cstddef>
+#include <new>
+
+#include <iterator.h>
+#include <iterator_tags.h>
+#include <iterator_traits.h>
+#include <type_traits.h>
+#include <utility.h>
+#include <vector.h>
+
+namespace rtl
+{
+	// Views are ranges computed on demand from another range. They hold iterators into it and copies of their
+	// parameters, never elements, so building a pipeline costs nothing and the elements are only computed while it is
+	// traversed:
+	//
+	//		vector<int> squares = collect(values | views::filter(isOdd) | views::transform(square) | views::take(10));
+	//
+	// makes a single pass over values and a single allocation. Views don't own their range: it must outlive them.
+	// Each view reports a size_hint(), an upper bound of its length, so collect() can reserve the result at once.
+
+	// ----- Range traits -----
+	template<class R>	struct range_iterator			{ typedef typename R::iterator type; };
+	template<class R>	struct range_iterator<const R>	{ typedef typename R::const_iterator type; };
+
+	template<class R>
+	struct range_value
+	{
+		typedef typename iterator_traits<typename range_iterator<R>::type>::value_type type;
+	};
+
+	namespace detail
+	{
+		template<class R>
+		auto size_hint(const R& r, int) -> decltype(size_t(r.size_hint()))	{ return r.size_hint(); }
+		template<class R>
+		auto size_hint(const R& r, long) -> decltype(size_t(r.size()))		{ return r.size(); }
+		template<class R>
+		size_t size_hint(const R&, ...)										{ return 0; }
+
+		// Category of It, capped to Max
+		template<class It, class Max>
+		struct cap_category
+		{
+			typedef typename iterator_traits<It>::iterator_category category;
+			typedef typename conditional<is_base_of<Max, category>::value, Max, category>::type type;
+		};
+
+		// The least refined of two categories
+		template<class A, class B>
+		struct min_category
+		{
+			typedef typename conditional<is_base_of<A, B>::value, A, B>::type type;
+		};
+
+		template<class It>
+		struct is_random_access : is_base_of<random_access_iterator_tag, typename iterator_traits<It>::iterator_category> {};
+
+		// Advances i by n, without going past end
+		template<class It>
+		void advance_bounded(It& i, size_t n, It end, input_iterator_tag)
+		{
+			for(; n && i != end; --n)
+				++i;
+		}
+
+		template<class It>
+		void advance_bounded(It& i, size_t n, It end, random_access_iterator_tag)
+		{
+			size_t left = size_t(end - i);
+			i += n < left ? n : left;
+		}
+
+		template<class It>
+		inline void advance_bounded(It& i, size_t n, It end)
+		{
+			advance_bounded(i, n, end, typename iterator_traits<It>::iterator_category());
+		}
+
+		// Category of iterators taking steps of several elements: random access if It is, forward otherwise. Stepping
+		// back from the end of a bidirectional range would need its length.
+		template<class It>
+		struct stepped_category
+		{
+			typedef typename conditional<is_random_access<It>::value, random_access_iterator_tag,
+				typename cap_category<It, forward_iterator_tag>::type>::type type;
+		};
+
+		// Index of the step at _offset, rounding up so the end of a range is the step after the last one
+		template<class Difference>
+		inline Difference stepped_index(Difference _offset, size_t _step)
+		{
+			return (_offset + Difference(_step) - 1) / Difference(_step);
+		}
+
+		// Offset of step _index, clamped to [0, _size]
+		template<class Difference>
+		inline Difference stepped_offset(Difference _index, size_t _step, Difference _size)
+		{
+			if(_index <= 0)
+				return 0;
+			return _index < stepped_index(_size, _step) ? _index * Difference(_step) : _size;
+		}
+
+		// Copy of a function object that can be reassigned, so iterators holding lambdas stay assignable
+		template<class F>
+		class function_box
+		{
+		public:
+			explicit function_box	(const F& f)			{ new(mStorage) F(f); }
+			function_box			(const function_box& x)	{ new(mStorage) F(x.get()); }
+			~function_box			()						{ get().~F(); }
+
+			function_box& operator=	(const function_box& x)
+			{
+				if(this != &x)
+				{
+					get().~F();
+					new(mStorage) F(x.get());
+				}
+				return *this;
+			}
+
+			const F&	get	() const	{ return *reinterpret_cast<const F*>(mStorage); }
+
+		private:
+			alignas(F) unsigned char mStorage[sizeof(F)];
+		};
+	}	// namespace detail
+
+	// Upper bound of the number of elements of a range: size_hint() for views, size() for containers, 0 if unknown
+	template<class R>
+	inline size_t size_hint(const R& r)
+	{
+		return detail::size_hint(r, 0);
+	}
+
+	// ----- View base -----
+	// Members every view derives from its begin() and end()
+	template<class Derived>
+	class view_interface
+	{
+	public:
+		bool	empty	() const { return derived().begin() == derived().end(); }
+
+		template<class V = Derived>
+		typename iterator_traits<typename V::iterator>::reference	front	() const { return *derived().begin(); }
+
+		// Random access views only
+		template<class V = Derived>
+		typename iterator_traits<typename V::iterator>::reference	operator[]	(size_t n) const
+		{
+			return derived().begin()[n];
+		}
+
+	private:
+		const Derived&	derived	() const { return static_cast<const Derived&>(*this); }
+	};
+
+	// ----- Subrange -----
+	// A pair of iterators
+	template<class It>
+	class subrange : public view_interface<subrange<It>>
+	{
+	public:
+		typedef It													iterator;
+		typedef It													const_iterator;
+		typedef typename iterator_traits<It>::value_type			value_type;
+
+		subrange(It first, It last, size_t hint) : mBegin(first), mEnd(last), mHint(hint) {}
+
+		iterator	begin		() const { return mBegin; }
+		iterator	end			() const { return mEnd; }
+		size_t		size_hint	() const { return mHint; }
+
+	private:
+		It		mBegin;
+		It		mEnd;
+		size_t	mHint;
+	};
+
+	// ----- Filter -----
+	// Elements of a range that satisfy a predicate. Forward only.
+	template<class It, class Pred>
+	class filter_iterator
+	{
+	public:
+		typedef typename iterator_traits<It>::value_type				value_type;
+		typedef typename iterator_traits<It>::difference_type			difference_type;
+		typedef typename iterator_traits<It>::pointer					pointer;
+		typedef typename iterator_traits<It>::reference					reference;
+		typedef typename detail::cap_category<It, forward_iterator_tag>::type	iterator_category;
+
+		filter_iterator(It cur, It end, const detail::function_box<Pred>& pred)
+			:mCur(cur), mEnd(end), mPred(pred)
+		{
+			satisfy();
+		}
+
+		reference			operator*	() const { return *mCur; }
+		filter_iterator&	operator++	()		{ ++mCur; satisfy(); return *this; }
+		filter_iterator		operator++	(int)	{ filter_iterator prev(*this); ++*this; return prev; }
+		bool				operator==	(const filter_iterator& x) const { return mCur == x.mCur; }
+
+		It					base		() const { return mCur; }
+
+	private:
+		void satisfy() { while(mCur != mEnd && !mPred.get()(*mCur)) ++mCur; }
+
+		It								mCur;
+		It								mEnd;
+		detail::function_box<Pred>		mPred;
+	};
+
+	template<class R, class Pred>
+	class filter_view : public view_interface<filter_view<R,Pred>>
+	{
+	public:
+		typedef filter_iterator<typename range_iterator<R>::type, Pred>	iterator;
+		typedef iterator												const_iterator;
+		typedef typename iterator::value_type							value_type;
+
+		filter_view(R& r, const Pred& pred) : mBegin(r.begin()), mEnd(r.end()), mPred(pred), mHint(rtl::size_hint(r)) {}
+
+		iterator	begin		() const { return iterator(mBegin, mEnd, mPred); }
+		iterator	end			() const { return iterator(mEnd, mEnd, mPred); }
+		size_t		size_hint	() const { return mHint; }	// Every element may pass
+
+	private:
+		typename range_iterator<R>::type	mBegin;
+		typename range_iterator<R>::type	mEnd;
+		detail::function_box<Pred>			mPred;
+		size_t								mHint;
+	};
+
+	// ----- Transform -----
+	// The results of applying a function to each element. Random access if the range is, but never contiguous.
+	template<class It, class F>
+	class transform_iterator
+	{
+	public:
+		typedef decltype(rtl::declval<const F&>()(*rtl::declval<It>()))						reference;
+		typedef typename remove_const<typename remove_reference<reference>::type>::type		value_type;
+		typedef typename iterator_traits<It>::difference_type								difference_type;
+		typedef void																		pointer;
+		typedef typename detail::cap_category<It, random_access_iterator_tag>::type			iterator_category;
+
+		transform_iterator(It cur, const detail::function_box<F>& f) : mCur(cur), mF(f) {}
+
+		reference				operator*	() const { return mF.get()(*mCur); }
+		reference				operator[]	(difference_type n) const { return mF.get()(mCur[n]); }
+
+		transform_iterator&		operator++	()		{ ++mCur; return *this; }
+		transform_iterator		operator++	(int)	{ transform_iterator prev(*this); ++mCur; return prev; }
+		transform_iterator&		operator--	()		{ --mCur; return *this; }
+		transform_iterator		operator--	(int)	{ transform_iterator prev(*this); --mCur; return prev; }
+
+		transform_iterator&		operator+=	(difference_type n)			{ mCur += n; return *this; }
+		transform_iterator&		operator-=	(difference_type n)			{ mCur -= n; return *this; }
+		transform_iterator		operator+	(difference_type n) const	{ return transform_iterator(mCur + n, mF); }
+		transform_iterator		operator-	(difference_type n) const	{ return transform_iterator(mCur - n, mF); }
+		difference_type			operator-	(const transform_iterator& x) const	{ return mCur - x.mCur; }
+
+		bool					operator==	(const transform_iterator& x) const	{ return mCur == x.mCur; }
+		bool					operator<	(const transform_iterator& x) const	{ return mCur < x.mCur; }
+
+		It						base		() const { return mCur; }
+
+	private:
+		It						mCur;
+		detail::function_box<F>	mF;
+	};
+
+	template<class R, class F>
+	class transform_view : public view_interface<transform_view<R,F>>
+	{
+	public:
+		typedef transform_iterator<typename range_iterator<R>::type, F>	iterator;
+		typedef iterator												const_iterator;
+		typedef typename iterator::value_type							value_type;
+
+		transform_view(R& r, const F& f) : mBegin(r.begin()), mEnd(r.end()), mF(f), mHint(rtl::size_hint(r)) {}
+
+		iterator	begin		() const { return iterator(mBegin, mF); }
+		iterator	end			() const { return iterator(mEnd, mF); }
+		size_t		size_hint	() const { return mHint; }
+
+	private:
+		typename range_iterator<R>::type	mBegin;
+		typename range_iterator<R>::type	mEnd;
+		detail::function_box<F>				mF;
+		size_t								mHint;
+	};
+
+	// ----- Take -----
+	// Counts down the elements left. Used by take_view over ranges that aren't random access.
+	template<class It>
+	class counted_iterator
+	{
+	public:
+		typedef typename iterator_traits<It>::value_type				value_type;
+		typedef typename iterator_traits<It>::difference_type			difference_type;
+		typedef typename iterator_traits<It>::pointer					pointer;
+		typedef typename iterator_traits<It>::reference					reference;
+		typedef typename detail::cap_category<It, forward_iterator_tag>::type	iterator_category;
+
+		counted_iterator(It cur, size_t left) : mCur(cur), mLeft(left) {}
+
+		reference			operator*	() const { return *mCur; }
+		counted_iterator&	operator++	()		{ ++mCur; --mLeft; return *this; }
+		counted_iterator	operator++	(int)	{ counted_iterator prev(*this); ++*this; return prev; }
+		// The end is reached either by exhausting the count or the underlying range
+		bool				operator==	(const counted_iterator& x) const
+		{
+			return (0 == mLeft && 0 == x.mLeft) || mCur == x.mCur;
+		}
+
+		It					base		() const { return mCur; }
+
+	private:
+		It		mCur;
+		size_t	mLeft;
+	};
+
+	// The first n elements of a range. Over random access ranges it iterates with the range's own iterators, so the
+	// category (contiguous included) is kept. Otherwise, the view is forward.
+	template<class R>
+	class take_view : public view_interface<take_view<R>>
+	{
+		typedef typename range_iterator<R>::type		baseT;
+		typedef detail::is_random_access<baseT>			randomAccessT;
+
+	public:
+		typedef typename conditional<randomAccessT::value, baseT, counted_iterator<baseT>>::type	iterator;
+		typedef iterator								const_iterator;
+		typedef typename range_value<R>::type			value_type;
+
+		take_view(R& r, size_t n) : mBegin(r.begin()), mEnd(r.end()), mCount(n)
+		{
+			size_t hint = rtl::size_hint(r);
+			if(randomAccessT::value)
+			{
+				// Bound the end, the count isn't needed any more
+				mEnd = mBegin;
+				detail::advance_bounded(mEnd, n, baseT(r.end()));
+				hint = size_t(rtl::distance(mBegin, mEnd));
+			}
+			mHint = n < hint ? n : hint;
+		}
+
+		iterator	begin		() const { return makeIterator(mBegin, mCount, randomAccessT()); }
+		iterator	end			() const { return makeIterator(mEnd, 0, randomAccessT()); }
+		size_t		size_hint	() const { return mHint; }
+
+	private:
+		static baseT					makeIterator	(baseT i, size_t, true_type)	{ return i; }
+		static counted_iterator<baseT>	makeIterator	(baseT i, size_t n, false_type)	{ return counted_iterator<baseT>(i, n); }
+
+		baseT		mBegin;
+		baseT		mEnd;
+		size_t		mCount;
+		size_t		mHint;
+	};
+
+	// ----- Drop -----
+	// All but the first n elements of a range. Iterates with the range's own iterators, so the category is kept.
+	template<class R>
+	class drop_view : public view_interface<drop_view<R>>
+	{
+	public:
+		typedef typename range_iterator<R>::type		iterator;
+		typedef iterator								const_iterator;
+		typedef typename range_value<R>::type			value_type;
+
+		drop_view(R& r, size_t n) : mBegin(r.begin()), mEnd(r.end())
+		{
+			detail::advance_bounded(mBegin, n, mEnd);
+			size_t hint = rtl::size_hint(r);
+			mHint = detail::is_random_access<iterator>::value ? size_t(rtl::distance(mBegin, mEnd)) : (hint > n ? hint - n : 0);
+		}
+
+		iterator	begin		() const { return mBegin; }
+		iterator	end			() const { return mEnd; }
+		size_t		size_hint	() const { return mHint; }
+
+	private:
+		iterator	mBegin;
+		iterator	mEnd;
+		size_t		mHint;
+	};
+
+	// ----- Zip -----
+	// Pairs of elements at the same position of two ranges, as long as the shortest one. Dereferences to a pair of
+	// references into both ranges.
+	template<class It1, class It2>
+	class zip_iterator
+	{
+	public:
+		typedef typename iterator_traits<It1>::reference		reference1;
+		typedef typename iterator_traits<It2>::reference		reference2;
+
+		typedef rtl::pair<reference1, reference2>				reference;
+		typedef rtl::pair<typename iterator_traits<It1>::value_type, typename iterator_traits<It2>::value_type>	value_type;
+		typedef typename iterator_traits<It1>::difference_type	difference_type;
+		typedef void											pointer;
+		typedef typename detail::min_category<
+			typename detail::cap_category<It1, random_access_iterator_tag>::type,
+			typename detail::cap_category<It2, random_access_iterator_tag>::type>::type	iterator_category;
+
+		// collect() and other consumers build value_type from what operator* returns
+		static_assert(is_convertible<reference, value_type>::value, "zip_iterator references must convert to values");
+
+		zip_iterator(It1 cur1, It2 cur2) : mCur1(cur1), mCur2(cur2) {}
+
+		reference			operator*	() const { return reference(*mCur1, *mCur2); }
+		reference			operator[]	(difference_type n) const { return reference(mCur1[n], mCur2[n]); }
+
+		zip_iterator&		operator++	()		{ ++mCur1; ++mCur2; return *this; }
+		zip_iterator		operator++	(int)	{ zip_iterator prev(*this); ++*this; return prev; }
+		zip_iterator&		operator--	()		{ --mCur1; --mCur2; return *this; }
+		zip_iterator		operator--	(int)	{ zip_iterator prev(*this); --*this; return prev; }
+
+		zip_iterator&		operator+=	(difference_type n)			{ mCur1 += n; mCur2 += n; return *this; }
+		zip_iterator&		operator-=	(difference_type n)			{ mCur1 -= n; mCur2 -= n; return *this; }
+		zip_iterator		operator+	(difference_type n) const	{ return zip_iterator(mCur1 + n, mCur2 + n); }
+		zip_iterator		operator-	(difference_type n) const	{ return zip_iterator(mCur1 - n, mCur2 - n); }
+		difference_type		operator-	(const zip_iterator& x) const
+		{
+			difference_type d1 = mCur1 - x.mCur1;
+			difference_type d2 = mCur2 - x.mCur2;
+			return d1 < d2 ? d1 : d2;
+		}
+
+		// Either range may be the one that ends first
+		bool				operator==	(const zip_iterator& x) const	{ return mCur1 == x.mCur1 || mCur2 == x.mCur2; }
+		bool				operator<	(const zip_iterator& x) const	{ return mCur1 < x.mCur1; }
+
+	private:
+		It1	mCur1;
+		It2	mCur2;
+	};
+
+	template<class R1, class R2>
+	class zip_view : public view_interface<zip_view<R1,R2>>
+	{
+	public:
+		typedef zip_iterator<typename range_iterator<R1>::type, typename range_iterator<R2>::type>	iterator;
+		typedef iterator												const_iterator;
+		typedef typename iterator::value_type							value_type;
+
+		zip_view(R1& r1, R2& r2) : mBegin(r1.begin(), r2.begin()), mEnd(r1.end(), r2.end())
+		{
+			size_t hint1 = rtl::size_hint(r1);
+			size_t hint2 = rtl::size_hint(r2);
+			mHint = hint1 < hint2 ? hint1 : hint2;
+		}
+
+		iterator	begin		() const { return mBegin; }
+		iterator	end			() const { return mEnd; }
+		size_t		size_hint	() const { return mHint; }
+
+	private:
+		iterator	mBegin;
+		iterator	mEnd;
+		size_t		mHint;
+	};
+
+	// ----- Chunk -----
+	// Consecutive subranges of n elements of a range. The last one may be shorter. Random access over random access
+	// ranges, forward otherwise.
+	template<class It>
+	class chunk_iterator
+	{
+	public:
+		typedef subrange<It>								value_type;
+		typedef subrange<It>								reference;
+		typedef typename iterator_traits<It>::difference_type	difference_type;
+		typedef void										pointer;
+		typedef typename detail::stepped_category<It>::type	iterator_category;
+
+		chunk_iterator(It begin, It cur, It end, size_t n) : mBegin(begin), mCur(cur), mNext(cur), mEnd(end), mN(n)
+		{
+			detail::advance_bounded(mNext, mN, mEnd);
+		}
+
+		reference			operator*	() const { return reference(mCur, mNext, mN); }
+		reference			operator[]	(difference_type n) const { return *(*this + n); }
+
+		chunk_iterator&		operator++	()
+		{
+			mCur = mNext;
+			detail::advance_bounded(mNext, mN, mEnd);
+			return *this;
+		}
+		chunk_iterator		operator++	(int)	{ chunk_iterator prev(*this); ++*this; return prev; }
+		chunk_iterator&		operator--	()		{ return *this -= 1; }
+		chunk_iterator		operator--	(int)	{ chunk_iterator prev(*this); --*this; return prev; }
+
+		// Random access only. Positions past the last chunk clamp to the end.
+		chunk_iterator&		operator+=	(difference_type n)
+		{
+			mCur = mBegin + detail::stepped_offset(index() + n, mN, mEnd - mBegin);
+			mNext = mCur;
+			detail::advance_bounded(mNext, mN, mEnd);
+			return *this;
+		}
+		chunk_iterator&		operator-=	(difference_type n)			{ return *this += -n; }
+		chunk_iterator		operator+	(difference_type n) const	{ chunk_iterator i(*this); return i += n; }
+		chunk_iterator		operator-	(difference_type n) const	{ chunk_iterator i(*this); return i -= n; }
+		difference_type		operator-	(const chunk_iterator& x) const	{ return index() - x.index(); }
+
+		bool				operator==	(const chunk_iterator& x) const	{ return mCur == x.mCur; }
+		bool				operator<	(const chunk_iterator& x) const	{ return mCur < x.mCur; }
+
+	private:
+		// Chunks start at multiples of mN, and the end counts as the chunk after the last one
+		difference_type		index		() const { return detail::stepped_index(mCur - mBegin, mN); }
+
+	private:
+		It		mBegin;
+		It		mCur;
+		It		mNext;	// End of the current chunk
+		It		mEnd;
+		size_t	mN;
+	};
+
+	template<class R>
+	class chunk_view : public view_interface<chunk_view<R>>
+	{
+	public:
+		typedef chunk_iterator<typename range_iterator<R>::type>	iterator;
+		typedef iterator											const_iterator;
+		typedef typename iterator::value_type						value_type;
+
+		chunk_view(R& r, size_t n) : mBegin(r.begin()), mEnd(r.end()), mN(n ? n : 1)
+		{
+			mHint = (rtl::size_hint(r) + mN - 1) / mN;
+		}
+
+		iterator	begin		() const { return iterator(mBegin, mBegin, mEnd, mN); }
+		iterator	end			() const { return iterator(mBegin, mEnd, mEnd, mN); }
+		size_t		size_hint	() const { return mHint; }
+
+	private:
+		typename range_iterator<R>::type	mBegin;
+		typename range_iterator<R>::type	mEnd;
+		size_t								mN;
+		size_t								mHint;
+	};
+
+	// ----- Stride -----
+	// Every n-th element of a range, starting with the first one. Random access over random access ranges, forward
+	// otherwise.
+	template<class It>
+	class stride_iterator
+	{
+	public:
+		typedef typename iterator_traits<It>::value_type				value_type;
+		typedef typename iterator_traits<It>::difference_type			difference_type;
+		typedef typename iterator_traits<It>::pointer					pointer;
+		typedef typename iterator_traits<It>::reference					reference;
+		typedef typename detail::stepped_category<It>::type				iterator_category;
+
+		stride_iterator(It begin, It cur, It end, size_t step) : mBegin(begin), mCur(cur), mEnd(end), mStep(step) {}
+
+		reference			operator*	() const { return *mCur; }
+		reference			operator[]	(difference_type n) const { return *(*this + n); }
+
+		stride_iterator&	operator++	()		{ detail::advance_bounded(mCur, mStep, mEnd); return *this; }
+		stride_iterator		operator++	(int)	{ stride_iterator prev(*this); ++*this; return prev; }
+		stride_iterator&	operator--	()		{ return *this -= 1; }
+		stride_iterator		operator--	(int)	{ stride_iterator prev(*this); --*this; return prev; }
+
+		// Random access only. Positions past the last element clamp to the end.
+		stride_iterator&	operator+=	(difference_type n)
+		{
+			mCur = mBegin + detail::stepped_offset(index() + n, mStep, mEnd - mBegin);
+			return *this;
+		}
+		stride_iterator&	operator-=	(difference_type n)			{ return *this += -n; }
+		stride_iterator		operator+	(difference_type n) const	{ stride_iterator i(*this); return i += n; }
+		stride_iterator		operator-	(difference_type n) const	{ stride_iterator i(*this); return i -= n; }
+		difference_type		operator-	(const stride_iterator& x) const	{ return index() - x.index(); }
+
+		bool				operator==	(const stride_iterator& x) const	{ return mCur == x.mCur; }
+		bool				operator<	(const stride_iterator& x) const	{ return mCur < x.mCur; }
+
+		It					base		() const { return mCur; }
+
+	private:
+		// Elements are at multiples of mStep, and the end counts as the position after the last one
+		difference_type		index		() const { return detail::stepped_index(mCur - mBegin, mStep); }
+
+	private:
+		It		mBegin;
+		It		mCur;
+		It		mEnd;
+		size_t	mStep;
+	};
+
+	template<class R>
+	class stride_view : public view_interface<stride_view<R>>
+	{
+	public:
+		typedef stride_iterator<typename range_iterator<R>::type>	iterator;
+		typedef iterator											const_iterator;
+		typedef typename iterator::value_type						value_type;
+
+		stride_view(R& r, size_t step) : mBegin(r.begin()), mEnd(r.end()), mStep(step ? step : 1)
+		{
+			mHint = (rtl::size_hint(r) + mStep - 1) / mStep;
+		}
+
+		iterator	begin		() const { return iterator(mBegin, mBegin, mEnd, mStep); }
+		iterator	end			() const { return iterator(mBegin, mEnd, mEnd, mStep); }
+		size_t		size_hint	() const { return mHint; }
+
+	private:
+		typename range_iterator<R>::type	mBegin;
+		typename range_iterator<R>::type	mEnd;
+		size_t								mStep;
+		size_t								mHint;
+	};
+
+	// ----- Adaptors -----
+	// Build views from a range, either by calling them (views::take(r, 3)) or by piping a range into them
+	// (r | views::take(3)).
+	namespace views
+	{
+		// Base of the adaptors that can be piped into
+		template<class Adaptor>
+		struct adaptor {};
+
+		template<class R, class Adaptor>
+		inline auto operator|(R&& r, const adaptor<Adaptor>& a) -> decltype(static_cast<const Adaptor&>(a)(r))
+		{
+			return static_cast<const Adaptor&>(a)(r);
+		}
+
+		template<class Pred>
+		struct filter_adaptor : adaptor<filter_adaptor<Pred>>
+		{
+			explicit filter_adaptor(const Pred& pred) : mPred(pred) {}
+			template<class R>
+			filter_view<R,Pred>	operator()(R& r) const { return filter_view<R,Pred>(r, mPred); }
+			Pred mPred;
+		};
+
+		template<class F>
+		struct transform_adaptor : adaptor<transform_adaptor<F>>
+		{
+			explicit transform_adaptor(const F& f) : mF(f) {}
+			template<class R>
+			transform_view<R,F>	operator()(R& r) const { return transform_view<R,F>(r, mF); }
+			F mF;
+		};
+
+		// Adaptors taking a count
+		template<template<class> class View>
+		struct count_adaptor : adaptor<count_adaptor<View>>
+		{
+			explicit count_adaptor(size_t n) : mN(n) {}
+			template<class R>
+			View<R>	operator()(R& r) const { return View<R>(r, mN); }
+			size_t mN;
+		};
+
+		template<class Pred>
+		inline filter_adaptor<Pred>		filter		(const Pred& pred)	{ return filter_adaptor<Pred>(pred); }
+		template<class F>
+		inline transform_adaptor<F>		transform	(const F& f)		{ return transform_adaptor<F>(f); }
+		inline count_adaptor<take_view>		take	(size_t n)			{ return count_adaptor<take_view>(n); }
+		inline count_adaptor<drop_view>		drop	(size_t n)			{ return count_adaptor<drop_view>(n); }
+		inline count_adaptor<chunk_view>	chunk	(size_t n)			{ return count_adaptor<chunk_view>(n); }
+		inline count_adaptor<stride_view>	stride	(size_t n)			{ return count_adaptor<stride_view>(n); }
+
+		// Ranges may be views built in the same expression, so these take forwarding references. The view only refers
+		// to the range, a temporary container would dangle.
+		template<class R, class Pred>
+		inline filter_view<typename remove_reference<R>::type, Pred>	filter		(R&& r, const Pred& pred)
+		{
+			return filter_view<typename remove_reference<R>::type, Pred>(r, pred);
+		}
+		template<class R, class F>
+		inline transform_view<typename remove_reference<R>::type, F>	transform	(R&& r, const F& f)
+		{
+			return transform_view<typename remove_reference<R>::type, F>(r, f);
+		}
+		template<class R>
+		inline take_view<typename remove_reference<R>::type>			take		(R&& r, size_t n)
+		{
+			return take_view<typename remove_reference<R>::type>(r, n);
+		}
+		template<class R>
+		inline drop_view<typename remove_reference<R>::type>			drop		(R&& r, size_t n)
+		{
+			return drop_view<typename remove_reference<R>::type>(r, n);
+		}
+		template<class R>
+		inline chunk_view<typename remove_reference<R>::type>			chunk		(R&& r, size_t n)
+		{
+			return chunk_view<typename remove_reference<R>::type>(r, n);
+		}
+		template<class R>
+		inline stride_view<typename remove_reference<R>::type>			stride		(R&& r, size_t n)
+		{
+			return stride_view<typename remove_reference<R>::type>(r, n);
+		}
+		template<class R1, class R2>
+		inline zip_view<typename remove_reference<R1>::type, typename remove_reference<R2>::type>	zip	(R1&& r1, R2&& r2)
+		{
+			return zip_view<typename remove_reference<R1>::type, typename remove_reference<R2>::type>(r1, r2);
+		}
+	}	// namespace views
+
+	// ----- Collect -----
+	// Appends the elements of a range to a vector, reserving room for size_hint() more elements first
+	template<class R, class T, class A>
+	vector<T,A>& collect(const R& r, vector<T,A>& out)
+	{
+		typedef typename range_iterator<const R>::type iteratorT;
+		out.reserve(out.size() + rtl::size_hint(r));
+		iteratorT last = r.end();
+		for(iteratorT i = r.begin(); i != last; ++i)
+			out.push_back(*i);
+		return out;
+	}
+
+	// Evaluates a range into a new vector
+	template<class R>
+	vector<typename range_value<const R>::type> collect(const R& r)
+	{
+		vector<typename range_value<const R>::type> out;
+		rtl::collect(r, out);
+		return out;	// Not the reference collect returns: that would copy the vector
+	}
+}	// namespace rtl
+
+#endif // _RTL_RANGES_H_
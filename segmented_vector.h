@@ -0,0 +1,346 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Standard templates library. Freestanding implementation.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Segmented vector
+
+#ifndef _RTL_SEGMENTED_VECTOR_H_
+#define _RTL_SEGMENTED_VECTOR_H_
+
+#include <bitops.h>
+#include <iterator_tags.h>
+#include <memory.h>
+#include <utility.h>
+
+namespace rtl
+{
+	// Sequence with the interface of rtl::vector that never moves its elements.
+	// Elements live in blocks whose sizes grow geometrically: block k holds (1<<FirstBlockBits) << k elements. Growing
+	// allocates the next block and leaves the others alone, so appending never copies elements nor invalidates pointers
+	// and references to them. The directory of blocks has one entry per bit of size_type, so it never grows either.
+	// Random access costs a bit scan on top of the vector's.
+	template < class T, class allocatorT = rtl::allocator<T>, unsigned FirstBlockBits = 4 >
+	class segmented_vector
+	{
+	public:
+		// Public types
+		typedef T				value_type;
+		typedef T&				reference;
+		typedef const T&		const_reference;
+		typedef T*				pointer;
+		typedef const T*		const_pointer;
+		typedef	allocatorT		allocator_type;
+
+		typedef	typename rtl::allocator_traits<allocatorT>::size_type		size_type;
+		typedef typename rtl::allocator_traits<allocatorT>::difference_type	difference_type;
+
+		class const_iterator;
+		class iterator;
+
+	public:
+		// Construction, destruction and copy
+		explicit	segmented_vector	(const allocatorT& = allocatorT());
+		segmented_vector	(const segmented_vector<T,allocatorT,FirstBlockBits>& x);
+		~segmented_vector	();
+		segmented_vector<T,allocatorT,FirstBlockBits>& operator=(const segmented_vector<T,allocatorT,FirstBlockBits>& x);
+
+		allocator_type get_allocator() const { return mAlloc; }
+
+	public:
+		// Iterators
+		iterator		begin	()			{ return iterator(this, 0); }
+		const_iterator	begin	() const	{ return const_iterator(this, 0); }
+		iterator		end		()			{ return iterator(this, mSize); }
+		const_iterator	end		() const	{ return const_iterator(this, mSize); }
+
+		// Size and capacity
+		size_type		size	() const		{ return mSize; }
+		size_type		max_size() const		{ return mAlloc.max_size(); }
+		void			resize	(size_type n);
+		void			resize	(size_type n, const T& x);
+		size_type		capacity() const		{ return blockStart(mNumBlocks); }
+		bool			empty	() const		{ return 0 == mSize; }
+		void			reserve	(size_type n)	{ while(capacity() < n) addBlock(); }
+		void			shrink_to_fit();
+
+		// Element access
+		reference		operator[]	(size_type n)		{ return *locate(n); }
+		const_reference operator[]	(size_type n) const { return *locate(n); }
+		const_reference at			(size_type n) const { return *locate(n); }
+		reference		at			(size_type n)		{ return *locate(n); }
+		reference		front		()			{ return *mBlocks[0]; }
+		const_reference	front		() const	{ return *mBlocks[0]; }
+		reference		back		()			{ return *locate(mSize-1); }
+		const_reference	back		() const	{ return *locate(mSize-1); }
+
+		// Modifiers
+		void			push_back	(const T&);
+		void			pop_back	();
+		void			swap		(segmented_vector<T,allocatorT,FirstBlockBits>&);
+		void			clear		();
+
+	public:
+		// ---- Nested classes ----
+		// Keeps the current block boundaries, so sequential traversal only scans the directory once per block
+		class const_iterator
+		{
+		public:
+			// Types
+			typedef T			value_type;
+			typedef const T*	pointer;
+			typedef const T&	reference;
+			typedef typename rtl::allocator_traits<allocatorT>::difference_type	difference_type;
+			typedef random_access_iterator_tag	iterator_category;
+
+			// Construction
+			const_iterator				()
+				: mOwner(0), mIndex(0), mElement(0), mBlockEnd(0) {}
+			const_iterator				(const segmented_vector* _owner, size_type _index)
+				: mOwner(_owner), mIndex(_index) { seek(); }
+
+			// Basic iterator requirements
+			reference		operator*	() const { return *mElement; }
+			pointer			operator->	() const { return mElement; }
+			const_iterator&	operator++	()
+			{
+				++mIndex;
+				if(++mElement == mBlockEnd)
+					seek();
+				return *this;
+			}
+			const_iterator	operator++	(int)	{ const_iterator prev(*this); ++*this; return prev; }
+
+			// bidirectional iterator requirements
+			const_iterator&	operator--	()		{ --mIndex; seek(); return *this; }
+			const_iterator	operator--	(int)	{ const_iterator prev(*this); --*this; return prev; }
+
+			// Random access iterator requirements
+			const_iterator& operator+=	(difference_type n) { mIndex += n; seek(); return *this; }
+			const_iterator& operator-=	(difference_type n) { mIndex -= n; seek(); return *this; }
+			const_iterator	operator+	(difference_type n) const { return const_iterator(mOwner, mIndex + n); }
+			const_iterator	operator-	(difference_type n) const { return const_iterator(mOwner, mIndex - n); }
+			difference_type	operator-	(const const_iterator& x) const { return difference_type(mIndex - x.mIndex); }
+			reference		operator[]	(difference_type n) const { return *mOwner->locate(mIndex + n); }
+
+			bool			operator==	(const const_iterator& x) const { return mIndex == x.mIndex; }
+			bool			operator<	(const const_iterator& x) const { return mIndex < x.mIndex; }
+
+		protected:
+			void seek()
+			{
+				if(mIndex < mOwner->capacity())
+				{
+					unsigned block = blockOf(mIndex);
+					mElement = mOwner->mBlocks[block] + (mIndex - blockStart(block));
+					mBlockEnd = mOwner->mBlocks[block] + blockSize(block);
+				}
+				else
+				{
+					// Past the last block. Leave ++ a way to notice.
+					mElement = 0;
+					mBlockEnd = 0;
+				}
+			}
+
+			const segmented_vector*	mOwner;
+			size_type				mIndex;
+			T*						mElement;
+			T*						mBlockEnd;
+		};
+
+		class iterator : public const_iterator
+		{
+		public:
+			// Types
+			typedef T			value_type;
+			typedef T*			pointer;
+			typedef T&			reference;
+			typedef typename rtl::allocator_traits<allocatorT>::difference_type	difference_type;
+			typedef random_access_iterator_tag	iterator_category;
+
+			// Construction
+			iterator				() {}
+			iterator				(const segmented_vector* _owner, size_type _index)
+				: const_iterator(_owner, _index) {}
+
+			// Basic iterator requirements
+			reference	operator*	() const { return *this->mElement; }
+			pointer		operator->	() const { return this->mElement; }
+			iterator&	operator++	()		{ const_iterator::operator++(); return *this; }
+			iterator	operator++	(int)	{ iterator prev(*this); ++*this; return prev; }
+
+			// bidirectional iterator requirements
+			iterator&	operator--	()		{ const_iterator::operator--(); return *this; }
+			iterator	operator--	(int)	{ iterator prev(*this); --*this; return prev; }
+
+			// Random access iterator requirements
+			iterator&	operator+=	(difference_type n) { const_iterator::operator+=(n); return *this; }
+			iterator&	operator-=	(difference_type n) { const_iterator::operator-=(n); return *this; }
+			iterator	operator+	(difference_type n) const { return iterator(this->mOwner, this->mIndex + n); }
+			iterator	operator-	(difference_type n) const { return iterator(this->mOwner, this->mIndex - n); }
+			difference_type	operator-	(const const_iterator& x) const { return const_iterator::operator-(x); }
+			reference	operator[]	(difference_type n) const { return const_cast<T&>(const_iterator::operator[](n)); }
+		};
+
+	private:
+		static const unsigned MaxBlocks = sizeof(size_type) * 8 - FirstBlockBits;
+
+		// Block layout
+		static size_type	blockSize	(unsigned _block)	{ return size_type(1) << (FirstBlockBits + _block); }
+		static size_type	blockStart	(unsigned _block)	{ return ((size_type(1) << _block) - 1) << FirstBlockBits; }
+		static unsigned		blockOf		(size_type _index)	{ return highest_bit((_index >> FirstBlockBits) + 1); }
+
+		T*		locate		(size_type _index) const;
+		void	addBlock	();
+		void	copyFrom	(const segmented_vector<T,allocatorT,FirstBlockBits>& x);
+
+	private:
+		size_type	mSize;
+		unsigned	mNumBlocks;
+		T*			mBlocks[MaxBlocks];
+		allocatorT	mAlloc;
+	};
+
+	// Specialized algorithms
+	template<class T, class allocatorT, unsigned FB>
+	void swap(segmented_vector<T,allocatorT,FB>& a, segmented_vector<T,allocatorT,FB>& b)
+	{
+		a.swap(b);
+	}
+
+	// ---- Segmented vector definition ----------------------------------------------------------------------------------
+	template<class T, class allocatorT, unsigned FB>
+	segmented_vector<T,allocatorT,FB>::segmented_vector(const allocatorT& _alloc)
+		:mSize(0)
+		,mNumBlocks(0)
+		,mAlloc(_alloc)
+	{
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT, unsigned FB>
+	segmented_vector<T,allocatorT,FB>::segmented_vector(const segmented_vector<T,allocatorT,FB>& x)
+		:mSize(0)
+		,mNumBlocks(0)
+		,mAlloc(x.mAlloc)
+	{
+		copyFrom(x);
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT, unsigned FB>
+	segmented_vector<T,allocatorT,FB>::~segmented_vector()
+	{
+		clear();
+		shrink_to_fit();
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT, unsigned FB>
+	segmented_vector<T,allocatorT,FB>& segmented_vector<T,allocatorT,FB>::operator=(const segmented_vector<T,allocatorT,FB>& x)
+	{
+		if(this != &x)
+		{
+			clear();	// Delete previous content, but keep the blocks
+			copyFrom(x);
+		}
+		return *this;
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT, unsigned FB>
+	void segmented_vector<T,allocatorT,FB>::resize(size_type n)
+	{
+		reserve(n);
+		while(n > mSize)
+			mAlloc.construct(locate(mSize++));
+		while(n < mSize)
+			mAlloc.destroy(locate(--mSize));
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT, unsigned FB>
+	void segmented_vector<T,allocatorT,FB>::resize(size_type n, const T& x)
+	{
+		reserve(n);
+		while(n > mSize)
+			mAlloc.construct(locate(mSize++), x);
+		while(n < mSize)
+			mAlloc.destroy(locate(--mSize));
+	}
+
+	//-----------------------------------------------------------------------
+	// Releases the blocks past the one holding the last element
+	template<class T, class allocatorT, unsigned FB>
+	void segmented_vector<T,allocatorT,FB>::shrink_to_fit()
+	{
+		unsigned neededBlocks = mSize ? blockOf(mSize-1) + 1 : 0;
+		while(mNumBlocks > neededBlocks)
+		{
+			--mNumBlocks;
+			allocator_traits<allocatorT>::deallocate(mAlloc, mBlocks[mNumBlocks], blockSize(mNumBlocks));
+		}
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT, unsigned FB>
+	void segmented_vector<T,allocatorT,FB>::push_back(const T& x)
+	{
+		if(mSize == capacity())
+			addBlock();
+		mAlloc.construct(locate(mSize), x);
+		++mSize;
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT, unsigned FB>
+	void segmented_vector<T,allocatorT,FB>::pop_back()
+	{
+		mAlloc.destroy(locate(--mSize));
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT, unsigned FB>
+	void segmented_vector<T,allocatorT,FB>::swap(segmented_vector<T,allocatorT,FB>& x)
+	{
+		rtl::swap(mSize, x.mSize);
+		rtl::swap(mNumBlocks, x.mNumBlocks);
+		for(unsigned i = 0; i < MaxBlocks; ++i)
+			rtl::swap(mBlocks[i], x.mBlocks[i]);
+		rtl::swap(mAlloc, x.mAlloc);
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT, unsigned FB>
+	void segmented_vector<T,allocatorT,FB>::clear()
+	{
+		resize(0);
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT, unsigned FB>
+	T* segmented_vector<T,allocatorT,FB>::locate(size_type _index) const
+	{
+		unsigned block = blockOf(_index);
+		return mBlocks[block] + (_index - blockStart(block));
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT, unsigned FB>
+	void segmented_vector<T,allocatorT,FB>::addBlock()
+	{
+		mBlocks[mNumBlocks] = allocator_traits<allocatorT>::allocate(mAlloc, blockSize(mNumBlocks));
+		++mNumBlocks;
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT, unsigned FB>
+	void segmented_vector<T,allocatorT,FB>::copyFrom(const segmented_vector<T,allocatorT,FB>& x)
+	{
+		reserve(x.mSize);
+		for(const_iterator i = x.begin(); i != x.end(); ++i)
+			push_back(*i);
+	}
+
+}	// namespace rtl
+
+#endif // _RTL_SEGMENTED_VECTOR_H_
@@ -0,0 +1,293 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Standard templates library. Freestanding implementation.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Snapshot: RCU style publishing of immutable container versions
+
+#ifndef _RTL_SNAPSHOT_H_
+#define _RTL_SNAPSHOT_H_
+
+#include <atomic>
+#include <cassert>
+#include <thread>
+
+#include <memory.h>
+
+namespace rtl
+{
+	// A snapshot holds the current version of some read-mostly object (typically an rtl::vector or rtl::dictionary).
+	// Writers build a whole new version and publish it with a single pointer swap. Readers pin the current version
+	// through a wait-free acquire() and only read it through const methods. Superseded versions are reclaimed once every
+	// reader that could have seen them has released its handle (epoch based reclamation).
+	// Each reader owns a cache line padded epoch slot, so readers never write to a line anyone else writes to, and
+	// only read the lines the writer touches once per publish.
+	// Writers must be serialized externally. Readers can run on any number of threads, up to NReaders at a time: a reader
+	// constructed while NReaders others exist waits for one of them to be destroyed.
+	template<class T, unsigned NReaders = 64, class allocatorT = rtl::allocator<T>>
+	class snapshot
+	{
+	public:
+		// Public types
+		typedef T				value_type;
+		typedef	allocatorT		allocator_type;
+		typedef	typename rtl::allocator_traits<allocatorT>::size_type		size_type;
+
+		class reader;
+		class read_handle;
+
+	public:
+		snapshot(const allocatorT& _alloc = allocatorT());
+		~snapshot();	// There must be no readers left
+
+		// Writer interface
+		T*			create		();				// New default constructed version, to be filled and then published
+		T*			create		(const T& _x);	// New version copied from _x
+		void		publish		(T* _version);	// _version must come from create(). The snapshot takes ownership.
+		size_type	collect		();				// Reclaims unreachable versions. Returns the number still pending.
+
+	public:
+		// ---- Nested classes ----
+		// Per thread reader registration. Claims an epoch slot on construction, waiting for one if all NReaders are taken,
+		// and frees it on destruction.
+		class reader
+		{
+		public:
+			explicit reader(snapshot& _owner);
+			~reader();
+
+			read_handle acquire();	// Wait-free
+
+		private:
+			reader(const reader&);
+			reader& operator=(const reader&);
+			void release();
+
+			friend class read_handle;
+			snapshot&	mOwner;
+			unsigned	mSlot;
+			unsigned	mPinCount;	// Nested acquisitions of this reader. Only touched by the reader's thread.
+		};
+
+		// Pins a version for as long as it lives
+		class read_handle
+		{
+		public:
+			read_handle(read_handle&& x) : mReader(x.mReader), mVersion(x.mVersion) { x.mReader = 0; }
+			~read_handle() { if(mReader) mReader->release(); }
+
+			const T&	operator*	() const { return *mVersion; }
+			const T*	operator->	() const { return mVersion; }
+			const T*	get			() const { return mVersion; }
+
+		private:
+			read_handle(reader* _reader, const T* _version) : mReader(_reader), mVersion(_version) {}
+			read_handle(const read_handle&);
+			read_handle& operator=(const read_handle&);
+
+			friend class reader;
+			reader*		mReader;
+			const T*	mVersion;
+		};
+
+	private:
+		static const unsigned CacheLineSize = 64;
+
+		// Epoch published by a reader while it holds a version, zero when quiescent
+		struct alignas(CacheLineSize) readerSlot
+		{
+			std::atomic<unsigned long long>	epoch;
+			std::atomic<bool>				inUse;
+		};
+
+		// Version waiting for the readers of older epochs to leave
+		struct retiredNode
+		{
+			T*					version;
+			unsigned long long	epoch;
+			retiredNode*		next;
+		};
+		typedef typename allocatorT::template rebind<retiredNode>::other	nodeAllocT;
+
+		void		destroyVersion	(T* _version);
+
+	private:
+		// Read by every reader, written once per publish
+		alignas(CacheLineSize) std::atomic<T*>				mCurrent;
+		std::atomic<unsigned long long>						mEpoch;
+		// Writer only
+		alignas(CacheLineSize) retiredNode*					mRetired;
+		size_type											mNumRetired;
+		allocatorT											mAlloc;
+		readerSlot											mSlots[NReaders];
+	};
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Snapshot implementation
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned NR, class allocatorT>
+	snapshot<T,NR,allocatorT>::snapshot(const allocatorT& _alloc)
+		:mCurrent(0)
+		,mEpoch(1)
+		,mRetired(0)
+		,mNumRetired(0)
+		,mAlloc(_alloc)
+	{
+		for(unsigned i = 0; i < NR; ++i)
+		{
+			mSlots[i].epoch.store(0, std::memory_order_relaxed);
+			mSlots[i].inUse.store(false, std::memory_order_relaxed);
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned NR, class allocatorT>
+	snapshot<T,NR,allocatorT>::~snapshot()
+	{
+		nodeAllocT nodeAlloc(mAlloc);
+		while(mRetired)
+		{
+			retiredNode* node = mRetired;
+			mRetired = node->next;
+			destroyVersion(node->version);
+			allocator_traits<nodeAllocT>::deallocate(nodeAlloc, node, 1);
+		}
+		T* current = mCurrent.load(std::memory_order_relaxed);
+		if(current)
+			destroyVersion(current);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned NR, class allocatorT>
+	T* snapshot<T,NR,allocatorT>::create()
+	{
+		T* version = allocator_traits<allocatorT>::allocate(mAlloc, 1);
+		mAlloc.construct(version);
+		return version;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned NR, class allocatorT>
+	T* snapshot<T,NR,allocatorT>::create(const T& _x)
+	{
+		T* version = allocator_traits<allocatorT>::allocate(mAlloc, 1);
+		mAlloc.construct(version, _x);
+		return version;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned NR, class allocatorT>
+	void snapshot<T,NR,allocatorT>::publish(T* _version)
+	{
+		// Readers that saw the old version have pinned an epoch no newer than retireEpoch
+		T* old = mCurrent.exchange(_version, std::memory_order_seq_cst);
+		unsigned long long retireEpoch = mEpoch.fetch_add(1, std::memory_order_seq_cst);
+		if(old)
+		{
+			nodeAllocT nodeAlloc(mAlloc);
+			retiredNode* node = allocator_traits<nodeAllocT>::allocate(nodeAlloc, 1);
+			node->version = old;
+			node->epoch = retireEpoch;
+			node->next = mRetired;
+			mRetired = node;
+			++mNumRetired;
+		}
+		collect();
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned NR, class allocatorT>
+	typename snapshot<T,NR,allocatorT>::size_type snapshot<T,NR,allocatorT>::collect()
+	{
+		// Find the oldest epoch still pinned
+		unsigned long long oldest = mEpoch.load(std::memory_order_seq_cst);
+		for(unsigned i = 0; i < NR; ++i)
+		{
+			unsigned long long pinned = mSlots[i].epoch.load(std::memory_order_seq_cst);
+			if(pinned && pinned < oldest)
+				oldest = pinned;
+		}
+		// Versions retired before that epoch are unreachable
+		nodeAllocT nodeAlloc(mAlloc);
+		retiredNode** link = &mRetired;
+		while(*link)
+		{
+			retiredNode* node = *link;
+			if(node->epoch < oldest)
+			{
+				*link = node->next;
+				destroyVersion(node->version);
+				allocator_traits<nodeAllocT>::deallocate(nodeAlloc, node, 1);
+				--mNumRetired;
+			}
+			else
+				link = &node->next;
+		}
+		return mNumRetired;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned NR, class allocatorT>
+	void snapshot<T,NR,allocatorT>::destroyVersion(T* _version)
+	{
+		mAlloc.destroy(_version);
+		allocator_traits<allocatorT>::deallocate(mAlloc, _version, 1);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	// Reader implementation
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned NR, class allocatorT>
+	snapshot<T,NR,allocatorT>::reader::reader(snapshot<T,NR,allocatorT>& _owner)
+		:mOwner(_owner)
+		,mSlot(NR)
+		,mPinCount(0)
+	{
+		while(mSlot == NR)
+		{
+			for(unsigned i = 0; i < NR; ++i)
+			{
+				bool expected = false;
+				if(mOwner.mSlots[i].inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+				{
+					mSlot = i;
+					break;
+				}
+			}
+			// Too many concurrent readers. Let the others run until one of them goes away.
+			if(mSlot == NR)
+				std::this_thread::yield();
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned NR, class allocatorT>
+	snapshot<T,NR,allocatorT>::reader::~reader()
+	{
+		assert(0 == mPinCount);	// Handles must not outlive their reader
+		mOwner.mSlots[mSlot].inUse.store(false, std::memory_order_release);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned NR, class allocatorT>
+	typename snapshot<T,NR,allocatorT>::read_handle snapshot<T,NR,allocatorT>::reader::acquire()
+	{
+		if(0 == mPinCount++)
+		{
+			// Pin the epoch before reading the version. If the writer's scan missed the pin, it also swapped the
+			// pointer before this load, so we get the new version.
+			unsigned long long epoch = mOwner.mEpoch.load(std::memory_order_seq_cst);
+			mOwner.mSlots[mSlot].epoch.store(epoch, std::memory_order_seq_cst);
+		}
+		return read_handle(this, mOwner.mCurrent.load(std::memory_order_seq_cst));
+	}
+
+	//------------------------------------------------------------------------------------------------------------------
+	template<class T, unsigned NR, class allocatorT>
+	void snapshot<T,NR,allocatorT>::reader::release()
+	{
+		if(0 == --mPinCount)
+			mOwner.mSlots[mSlot].epoch.store(0, std::memory_order_release);
+	}
+
+}	// namespace rtl
+
+#endif // _RTL_SNAPSHOT_H_
@@ -0,0 +1,408 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Standard templates library. Freestanding implementation.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static vector: fixed capacity vector with inline storage
+
+#ifndef _RTL_STATIC_VECTOR_H_
+#define _RTL_STATIC_VECTOR_H_
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+
+#include <iterator_traits.h>
+#include <type_traits.h>
+#include <utility.h>
+
+namespace rtl
+{
+	// Tag requesting a constant initialized static_vector, see static_vector
+	struct constant_init_t {};
+	constexpr constant_init_t constant_init = constant_init_t();
+
+	namespace detail
+	{
+		// Element storage of static_vector. Arrays of trivial types are plain arrays, so static vectors of them are
+		// trivially copyable and destructible, and can be constant initialized.
+		template<class T, size_t N, bool = is_trivial<T>::value>
+		class static_vector_storage
+		{
+		protected:
+			// Elements past mSize are left uninitialized, so construction doesn't depend on N. Constant initialization
+			// can't leave anything uninitialized: it has to value-initialize the array.
+			static_vector_storage() : mSize(0) {}
+			constexpr explicit static_vector_storage(constant_init_t) : mSize(0), mData() {}
+
+			T*			ptr	()			{ return mData; }
+			const T*	ptr	() const	{ return mData; }
+
+			size_t	mSize;
+			T		mData[N];
+		};
+
+		// Other types live in raw memory, constructed and destroyed one by one
+		template<class T, size_t N>
+		class static_vector_storage<T, N, false>
+		{
+		protected:
+			static_vector_storage() : mSize(0) {}
+			explicit static_vector_storage(constant_init_t) : mSize(0) {}
+			static_vector_storage(const static_vector_storage& _x) : mSize(0)
+			{
+				for(; mSize < _x.mSize; ++mSize)
+					new(&ptr()[mSize]) T(_x.ptr()[mSize]);
+			}
+			// Moves element by element. The source keeps its size, with moved from elements.
+			static_vector_storage(static_vector_storage&& _x) : mSize(0)
+			{
+				for(; mSize < _x.mSize; ++mSize)
+					new(&ptr()[mSize]) T(rtl::move(_x.ptr()[mSize]));
+			}
+			~static_vector_storage() { shrink(0); }
+
+			static_vector_storage& operator=(const static_vector_storage& _x)
+			{
+				if(this != &_x)
+				{
+					shrink(0);
+					for(; mSize < _x.mSize; ++mSize)
+						new(&ptr()[mSize]) T(_x.ptr()[mSize]);
+				}
+				return *this;
+			}
+
+			static_vector_storage& operator=(static_vector_storage&& _x)
+			{
+				if(this != &_x)
+				{
+					shrink(0);
+					for(; mSize < _x.mSize; ++mSize)
+						new(&ptr()[mSize]) T(rtl::move(_x.ptr()[mSize]));
+				}
+				return *this;
+			}
+
+			T*			ptr	()			{ return reinterpret_cast<T*>(mStorage); }
+			const T*	ptr	() const	{ return reinterpret_cast<const T*>(mStorage); }
+
+			void shrink(size_t _n)
+			{
+				while(mSize > _n)
+					ptr()[--mSize].~T();
+			}
+
+			size_t	mSize;
+			alignas(T) unsigned char mStorage[N * sizeof(T)];
+		};
+	}	// namespace detail
+
+	// Vector with the capacity fixed at compile time and the elements stored inside the object. It never allocates,
+	// so it can be used where there's no heap, or where taking a lock in the allocator isn't an option. Iterators are
+	// pointers.
+	// Overflow policy: operations that would exceed N are precondition violations. They assert in debug builds and, with
+	// NDEBUG, leave the vector unchanged (try_push_back reports it instead). Range insertions stop at capacity.
+	template<class T, size_t N>
+	class static_vector : public detail::static_vector_storage<T, N>
+	{
+		static_assert(N > 0, "static_vector needs some capacity");
+
+	public:
+		// Public types
+		typedef T				value_type;
+		typedef T&				reference;
+		typedef const T&		const_reference;
+		typedef T*				pointer;
+		typedef const T*		const_pointer;
+		typedef T*				iterator;
+		typedef const T*		const_iterator;
+		typedef size_t			size_type;
+		typedef ptrdiff_t		difference_type;
+
+	public:
+		// Construction
+		// Constant time whatever N is
+					static_vector	() {}
+		// Constexpr for trivial T, for objects that must be constant initialized (e.g. used during dynamic
+		// initialization). Zero fills the N elements, which costs nothing for objects of static storage duration but is a
+		// memset of the whole array anywhere else.
+		constexpr explicit	static_vector	(constant_init_t)	: detail::static_vector_storage<T, N>(constant_init) {}
+		explicit	static_vector	(size_type n)				{ resize(n); }
+		static_vector	(size_type n, const T& x)				{ resize(n, x); }
+		template<class InputIterator>
+		static_vector	(InputIterator first, InputIterator last)	{ insert(end(), first, last); }
+
+	public:
+		// Iterators
+		iterator		begin	()			{ return this->ptr(); }
+		const_iterator	begin	() const	{ return this->ptr(); }
+		iterator		end		()			{ return this->ptr() + this->mSize; }
+		const_iterator	end		() const	{ return this->ptr() + this->mSize; }
+
+		// Size and capacity
+		size_type		size	() const		{ return this->mSize; }
+		size_type		max_size() const		{ return N; }
+		size_type		capacity() const		{ return N; }
+		bool			empty	() const		{ return 0 == this->mSize; }
+		bool			full	() const		{ return N == this->mSize; }
+		void			resize	(size_type n);
+		void			resize	(size_type n, const T& x);
+		void			reserve	(size_type n)	{ assert(n <= N); (void)n; }
+		void			shrink_to_fit()			{}
+
+		// Element access
+		reference		operator[]	(size_type n)		{ return this->ptr()[n]; }
+		const_reference operator[]	(size_type n) const { return this->ptr()[n]; }
+		const_reference at			(size_type n) const { return this->ptr()[n]; }
+		reference		at			(size_type n)		{ return this->ptr()[n]; }
+		reference		front		()			{ return this->ptr()[0]; }
+		const_reference	front		() const	{ return this->ptr()[0]; }
+		reference		back		()			{ return this->ptr()[this->mSize-1]; }
+		const_reference	back		() const	{ return this->ptr()[this->mSize-1]; }
+
+		// Data access
+		T*				data		()			{ return this->ptr(); }
+		const T*		data		() const	{ return this->ptr(); }
+
+		// Modifiers
+		void			push_back		(const T& x)	{ bool pushed = try_push_back(x); assert(pushed); (void)pushed; }
+		void			push_back		(T&& x)			{ bool pushed = try_push_back(rtl::move(x)); assert(pushed); (void)pushed; }
+		// Return false, leaving the vector unchanged, when it is full
+		bool			try_push_back	(const T& x);
+		bool			try_push_back	(T&& x);
+		void			pop_back		();
+		iterator		insert		(const_iterator position, const T& x);
+		iterator		insert		(const_iterator position, T&& x);
+		iterator		insert		(const_iterator position, size_type n, const T& x);
+		template<class InputIterator>
+		iterator		insert		(const_iterator position, InputIterator first, InputIterator last);
+		iterator		erase		(const_iterator position)	{ return erase(position, position + 1); }
+		iterator		erase		(const_iterator first, const_iterator last);
+		void			swap		(static_vector&);
+		void			clear		()	{ resize(0); }
+
+		// Operators
+		bool			operator==	(const static_vector&) const;
+		bool			operator<	(const static_vector&) const;
+
+	private:
+		template<class Integer>
+		iterator		insertDispatch	(const_iterator position, Integer n, Integer x, true_type);
+		template<class InputIterator>
+		iterator		insertDispatch	(const_iterator position, InputIterator first, InputIterator last, false_type);
+
+		// Rotates [first, last) so middle becomes the first element
+		static void		rotate		(T* first, T* middle, T* last);
+	};
+
+	// Specialized algorithms
+	template<class T, size_t N>
+	void swap(static_vector<T,N>& a, static_vector<T,N>& b)
+	{
+		a.swap(b);
+	}
+
+	// ---- Static vector definition -------------------------------------------------------------------------------
+	template<class T, size_t N>
+	void static_vector<T,N>::resize(size_type n)
+	{
+		assert(n <= N);
+		if(n > N)
+			return;
+		while(this->mSize > n)
+			this->ptr()[--this->mSize].~T();
+		while(this->mSize < n)
+			new(&this->ptr()[this->mSize++]) T();
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, size_t N>
+	void static_vector<T,N>::resize(size_type n, const T& x)
+	{
+		assert(n <= N);
+		if(n > N)
+			return;
+		while(this->mSize > n)
+			this->ptr()[--this->mSize].~T();
+		while(this->mSize < n)
+			new(&this->ptr()[this->mSize++]) T(x);
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, size_t N>
+	bool static_vector<T,N>::try_push_back(const T& x)
+	{
+		if(full())
+			return false;
+		new(&this->ptr()[this->mSize]) T(x);
+		++this->mSize;
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, size_t N>
+	bool static_vector<T,N>::try_push_back(T&& x)
+	{
+		if(full())
+			return false;
+		new(&this->ptr()[this->mSize]) T(rtl::move(x));
+		++this->mSize;
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, size_t N>
+	void static_vector<T,N>::pop_back()
+	{
+		assert(!empty());
+		this->ptr()[--this->mSize].~T();
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, size_t N>
+	typename static_vector<T,N>::iterator static_vector<T,N>::insert(const_iterator position, const T& x)
+	{
+		return insert(position, 1, x);
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, size_t N>
+	typename static_vector<T,N>::iterator static_vector<T,N>::insert(const_iterator position, T&& x)
+	{
+		T* pos = begin() + (position - begin());
+		assert(!full());
+		if(!try_push_back(rtl::move(x)))
+			return pos;
+		rotate(pos, end() - 1, end());
+		return pos;
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, size_t N>
+	typename static_vector<T,N>::iterator static_vector<T,N>::insert(const_iterator position, size_type n, const T& x)
+	{
+		T* pos = begin() + (position - begin());
+		assert(n <= N - size());
+		if(n > N - size())
+			return pos;
+		T value(x);	// x may be one of our elements
+		for(size_type i = 0; i < n; ++i)
+			new(&this->ptr()[this->mSize++]) T(value);
+		rotate(pos, end() - n, end());
+		return pos;
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, size_t N>
+	template<class InputIterator>
+	typename static_vector<T,N>::iterator static_vector<T,N>::insert(const_iterator position,
+		InputIterator first, InputIterator last)
+	{
+		return insertDispatch(position, first, last, is_integral<InputIterator>());
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, size_t N>
+	template<class Integer>
+	typename static_vector<T,N>::iterator static_vector<T,N>::insertDispatch(const_iterator position,
+		Integer n, Integer x, true_type)
+	{
+		return insert(position, size_type(n), T(x));
+	}
+
+	//-----------------------------------------------------------------------
+	// Appends the range, then moves it into place
+	template<class T, size_t N>
+	template<class InputIterator>
+	typename static_vector<T,N>::iterator static_vector<T,N>::insertDispatch(const_iterator position,
+		InputIterator first, InputIterator last, false_type)
+	{
+		T* pos = begin() + (position - begin());
+		T* oldEnd = end();
+		for(; first != last; ++first)
+		{
+			if(full())
+			{
+				assert(!"static_vector overflow");
+				break;
+			}
+			new(&this->ptr()[this->mSize++]) T(*first);
+		}
+		rotate(pos, oldEnd, end());
+		return pos;
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, size_t N>
+	typename static_vector<T,N>::iterator static_vector<T,N>::erase(const_iterator first, const_iterator last)
+	{
+		T* dst = begin() + (first - begin());
+		T* src = begin() + (last - begin());
+		T* e = end();
+		for(; src != e; ++src, ++dst)
+			*dst = rtl::move(*src);
+		size_type n = size_type(last - first);
+		while(n--)
+			this->ptr()[--this->mSize].~T();
+		return begin() + (first - begin());
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, size_t N>
+	void static_vector<T,N>::swap(static_vector& x)
+	{
+		static_vector* shorter = size() < x.size() ? this : &x;
+		static_vector* longer = size() < x.size() ? &x : this;
+		size_type common = shorter->size();
+		for(size_type i = 0; i < common; ++i)
+			rtl::swap((*this)[i], x[i]);
+		// Move the excess of the longer one
+		for(size_type i = common; i < longer->size(); ++i)
+			new(&shorter->ptr()[i]) T(rtl::move((*longer)[i]));
+		shorter->mSize = longer->mSize;
+		while(longer->mSize > common)
+			longer->ptr()[--longer->mSize].~T();
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, size_t N>
+	bool static_vector<T,N>::operator==(const static_vector& x) const
+	{
+		if(size() != x.size())
+			return false;
+		for(size_type i = 0; i < size(); ++i)
+		{
+			if(!((*this)[i] == x[i]))
+				return false;
+		}
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, size_t N>
+	bool static_vector<T,N>::operator<(const static_vector& x) const
+	{
+		for(size_type i = 0; i < size() && i < x.size(); ++i)
+		{
+			if((*this)[i] < x[i])
+				return true;
+			if(x[i] < (*this)[i])
+				return false;
+		}
+		return size() < x.size();
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, size_t N>
+	void static_vector<T,N>::rotate(T* first, T* middle, T* last)
+	{
+		// Reverse both halves, then the whole range
+		for(T *a = first, *b = middle; a < b; )
+			rtl::swap(*a++, *--b);
+		for(T *a = middle, *b = last; a < b; )
+			rtl::swap(*a++, *--b);
+		for(T *a = first, *b = last; a < b; )
+			rtl::swap(*a++, *--b);
+	}
+}	// namespace rtl
+
+#endif // _RTL_STATIC_VECTOR_H_
@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Standard templates library. Freestanding implementation.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Type traits
+
+#ifndef _RTL_TYPE_TRAITS_H_
+#define _RTL_TYPE_TRAITS_H_
+
+namespace rtl
+{
+	// ----- Helper classes -----
+	template<class T, T v>
+	struct integral_constant
+	{
+		typedef T					value_type;
+		typedef integral_constant	type;
+		static const T value = v;
+	};
+
+	template<class T, T v>
+	const T integral_constant<T,v>::value;
+
+	typedef integral_constant<bool, true>	true_type;
+	typedef integral_constant<bool, false>	false_type;
+
+	// ----- Type relations -----
+	template<class T, class U>	struct is_same			: false_type {};
+	template<class T>			struct is_same<T,T>		: true_type {};
+
+	template<class Base, class Derived>
+	struct is_base_of : integral_constant<bool, __is_base_of(Base, Derived)> {};
+
+	// ----- Type properties -----
+	template<class T>	struct is_integral						: false_type {};
+	template<class T>	struct is_integral<const T>				: is_integral<T> {};
+	template<>			struct is_integral<bool>				: true_type {};
+	template<>			struct is_integral<char>				: true_type {};
+	template<>			struct is_integral<signed char>			: true_type {};
+	template<>			struct is_integral<unsigned char>		: true_type {};
+	template<>			struct is_integral<wchar_t>				: true_type {};
+	template<>			struct is_integral<short>				: true_type {};
+	template<>			struct is_integral<unsigned short>		: true_type {};
+	template<>			struct is_integral<int>					: true_type {};
+	template<>			struct is_integral<unsigned>			: true_type {};
+	template<>			struct is_integral<long>				: true_type {};
+	template<>			struct is_integral<unsigned long>		: true_type {};
+	template<>			struct is_integral<long long>			: true_type {};
+	template<>			struct is_integral<unsigned long long>	: true_type {};
+
+	template<class T>	struct is_lvalue_reference		: false_type {};
+	template<class T>	struct is_lvalue_reference<T&>	: true_type {};
+
+	// Objects of trivially copyable types can be copied and relocated with memcpy
+	template<class T>
+	struct is_trivially_copyable : integral_constant<bool, __is_trivially_copyable(T)> {};
+
+	// Trivial types are trivially copyable and trivially default constructible: plain arrays of them need no
+	// construction nor destruction
+	template<class T>
+	struct is_trivial : integral_constant<bool, __is_trivial(T)> {};
+
+	// From can be implicitly converted to To
+	namespace detail
+	{
+		template<class To>	char	convertible_test(To);
+		template<class To>	long	convertible_test(...);
+		template<class T>	T&&		make_value();
+	}
+
+	template<class From, class To>
+	struct is_convertible
+		: integral_constant<bool, sizeof(detail::convertible_test<To>(detail::make_value<From>())) == sizeof(char)> {};
+
+	// ----- Type modifications -----
+	template<class T>	struct remove_reference			{ typedef T type; };
+	template<class T>	struct remove_reference<T&>		{ typedef T type; };
+	template<class T>	struct remove_reference<T&&>	{ typedef T type; };
+
+	template<class T>	struct remove_const				{ typedef T type; };
+	template<class T>	struct remove_const<const T>	{ typedef T type; };
+
+	// ----- Other transformations -----
+	template<bool B, class T, class F>	struct conditional				{ typedef T type; };
+	template<class T, class F>			struct conditional<false,T,F>	{ typedef F type; };
+}	// namespace rtl
+
+#endif // _RTL_TYPE_TRAITS_H_
@@ -8,17 +8,42 @@
 #define _RTL_UTILITY_H_
 
 #include "utility_operartors.h"
+#include <type_traits.h>
 
 namespace rtl
 {
 	// TODO: General utilities
+	// Move. Casts to an rvalue reference, so the object's resources can be taken instead of copied.
+	template <class T>
+	inline typename remove_reference<T>::type&& move(T&& a)
+	{
+		return static_cast<typename remove_reference<T>::type&&>(a);
+	}
+
+	// Forward. Passes on a forwarding reference with the value category it was given.
+	template <class T>
+	inline T&& forward(typename remove_reference<T>::type& a)
+	{
+		return static_cast<T&&>(a);
+	}
+
+	template <class T>
+	inline T&& forward(typename remove_reference<T>::type&& a)
+	{
+		return static_cast<T&&>(a);
+	}
+
+	// Declval. Names a value of type T in unevaluated contexts (decltype), without constructing one. Never defined.
+	template <class T>
+	T&& declval();
+
 	// Swap
 	template <class T>
 	inline void swap(T& a, T& b)
 	{
-		T temp = a;
-		a = b;
-		b = temp;
+		T temp = rtl::move(a);
+		a = rtl::move(b);
+		b = rtl::move(temp);
 	}
 
 	// ----- Pair declaration -------------
@@ -32,8 +57,14 @@ namespace rtl
 		T2 second;
 
 		pair(const T1& _first = T1(), const T2& _second = T2());
+		pair(const pair&);
+		pair(pair&&);
+		// From pairs of convertible types, e.g. a pair of references into a pair of values
+		template<class U1, class U2>
+		pair(const pair<U1,U2>&);
 
 		pair& operator=(const pair&);
+		pair& operator=(pair&&);
 
 		void swap(pair&);
 	};
@@ -45,6 +76,25 @@ namespace rtl
 		,second(b)
 	{}
 
+	template < class T1, class T2 >
+	inline pair<T1, T2>::pair(const pair<T1,T2>& p)
+		:first(p.first)
+		,second(p.second)
+	{}
+
+	template < class T1, class T2 >
+	inline pair<T1, T2>::pair(pair<T1,T2>&& p)
+		:first(rtl::forward<T1>(p.first))
+		,second(rtl::forward<T2>(p.second))
+	{}
+
+	template < class T1, class T2 >
+	template < class U1, class U2 >
+	inline pair<T1, T2>::pair(const pair<U1,U2>& p)
+		:first(p.first)
+		,second(p.second)
+	{}
+
 	template < class T1, class T2 >
 	pair<T1,T2>& pair<T1,T2>::operator=(const pair<T1,T2>& p)
 	{
@@ -53,11 +103,19 @@ namespace rtl
 		return *this;
 	}
 
+	template < class T1, class T2 >
+	pair<T1,T2>& pair<T1,T2>::operator=(pair<T1,T2>&& p)
+	{
+		first = rtl::forward<T1>(p.first);
+		second = rtl::forward<T2>(p.second);
+		return *this;
+	}
+
 	template < class T1, class T2 >
 	void pair<T1,T2>::swap(pair& p)
 	{
-		swap(first, p.first);
-		swap(second, p.second);
+		rtl::swap(first, p.first);
+		rtl::swap(second, p.second);
 	}
 
 	// ----------- specialized algorithms -------------
@@ -88,6 +146,50 @@ namespace rtl
 	{
 		return pair<T1,T2>(a, b);
 	}
+
+	// ----- Compressed pair -------------
+	// Pair of values that takes no room for an empty first member (typically a stateless allocator), by deriving from
+	// it instead of storing it (empty base optimization).
+	template < class T1, class T2, bool = __is_empty(T1) && !__is_final(T1) >
+	class compressed_pair
+	{
+	public:
+		compressed_pair(const T1& _first = T1(), const T2& _second = T2())
+			:mFirst(_first)
+			,mSecond(_second)
+		{}
+
+		T1&			first	()			{ return mFirst; }
+		const T1&	first	() const	{ return mFirst; }
+		T2&			second	()			{ return mSecond; }
+		const T2&	second	() const	{ return mSecond; }
+
+		void		swap	(compressed_pair& p)	{ rtl::swap(mFirst, p.mFirst); rtl::swap(mSecond, p.mSecond); }
+
+	private:
+		T1 mFirst;
+		T2 mSecond;
+	};
+
+	template < class T1, class T2 >
+	class compressed_pair<T1, T2, true> : private T1
+	{
+	public:
+		compressed_pair(const T1& _first = T1(), const T2& _second = T2())
+			:T1(_first)
+			,mSecond(_second)
+		{}
+
+		T1&			first	()			{ return *this; }
+		const T1&	first	() const	{ return *this; }
+		T2&			second	()			{ return mSecond; }
+		const T2&	second	() const	{ return mSecond; }
+
+		void		swap	(compressed_pair& p)	{ rtl::swap(mSecond, p.mSecond); }
+
+	private:
+		T2 mSecond;
+	};
 }	// namespace rtl
 
 #endif // _RTL_UTILITY_H_
\ No newline at end of file
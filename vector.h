@@ -7,8 +7,13 @@
 #ifndef _RTL_VECTOR_H_
 #define _RTL_VECTOR_H_
 
+#include <cassert>
+#include <cstring>
+
+#include <iterator.h>
 #include <iterator_tags.h>
 #include <memory.h>
+#include <type_traits.h>
 #include <utility.h>
 
 namespace rtl
@@ -36,11 +41,17 @@ namespace rtl
 		explicit	vector	(const allocatorT& = allocatorT());	// Default constructor
 		explicit	vector	(size_type n);
 		vector	(size_type n, const T& x, const allocatorT& alloc = allocatorT());
+		// Range constructor. Forward ranges are allocated at once, contiguous ranges of trivially copyable elements are
+		// copied in a single memcpy.
+		template<class InputIterator>
+		vector	(InputIterator first, InputIterator last, const allocatorT& alloc = allocatorT());
 		vector	(const vector<T,allocatorT>& x);	// Copy constructor
+		vector	(vector<T,allocatorT>&& x);			// Move constructor
 		~vector	();	// Destructor
 		vector<T,allocatorT>& operator=(const vector<T,allocatorT>& x);
+		vector<T,allocatorT>& operator=(vector<T,allocatorT>&& x);
 
-		allocator_type get_allocator() const { return mAlloc; }
+		allocator_type get_allocator() const { return alloc(); }
 
 	public:
 		// Iterators
@@ -51,13 +62,13 @@ namespace rtl
 
 		// Size and capacity
 		size_type		size	() const		{ return mSize; }
-		size_type		max_size() const		{ return mAlloc.max_size; }
+		size_type		max_size() const		{ return alloc().max_size(); }
 		void			resize	(size_type n);
 		void			resize	(size_type n, const T& x);
-		size_type		capacity() const		{return mCapacity; }
+		size_type		capacity() const		{return mAllocCapacity.second(); }
 		bool			empty	() const		{ return 0 == mSize; }
-		void			reserve	(size_type n)	{ if(n>mCapacity) reallocate(n); }
-		void			shrink_to_fit()			{ if(mSize != mCapacity) reallocate(mSize); }
+		void			reserve	(size_type n)	{ if(n>capacity()) reallocate(n); }
+		void			shrink_to_fit()			{ if(mSize != capacity()) reallocate(mSize); }
 
 		// Element access
 		reference		operator[]	(size_type n)		{ return mData[n]; }
@@ -75,9 +86,13 @@ namespace rtl
 
 		// Modifiers
 		void			push_back	(const T&);
+		void			push_back	(T&&);
 		void			pop_back	();
 		iterator		insert		(const_iterator position, const T& x);
+		iterator		insert		(const_iterator position, T&& x);
 		iterator		insert		(const_iterator position, size_type n, const T& x);
+		// Range insertion. Like the range constructor, it reserves once for forward ranges and copies contiguous
+		// ranges of trivially copyable elements in bulk. Wrap the range in move_iterators to move the elements.
 		template<class InputIterator>
 		iterator		insert		(const_iterator position,
 									InputIterator first, InputIterator last);
@@ -85,6 +100,11 @@ namespace rtl
 		iterator		erase		(const iterator first, const iterator last);
 		void			swap		(vector<T,allocatorT>&);
 		void			clear		();
+		// Appends elements written in place by a producer, e.g. a read from a file. Reserves room for n more elements
+		// and calls op(T* dst, size_type n), which fills the first k of them and returns k. Only for trivially
+		// copyable types: the new elements aren't constructed before op writes them. Returns k.
+		template<class Operation>
+		size_type		append_uninitialized	(size_type n, Operation op);
 
 		// Operators
 		bool			operator==	(const vector<T,allocatorT>&) const;
@@ -100,7 +120,7 @@ namespace rtl
 			typedef const T*	pointer;
 			typedef const T&	reference;
 			typedef typename rtl::allocator_traits<allocatorT>::difference_type	difference_type;
-			typedef random_access_iterator_tag	iterator_category;
+			typedef contiguous_iterator_tag		iterator_category;
 
 			// Construction, copy and destruction
 			const_iterator				()	// default constructor
@@ -110,7 +130,7 @@ namespace rtl
 			const_iterator				(const const_iterator& x)	// Copy constructor
 				:mData(x.mData) {}
 			const_iterator& operator=	(const const_iterator& x)	// Assignment operator
-			{ mData = x.mData; }
+			{ mData = x.mData; return *this; }
 			~const_iterator				() {}
 
 			// Basic iterator requirements
@@ -121,21 +141,22 @@ namespace rtl
 			bool			operator==	(const const_iterator& x) const	// Equality comparison
 				 { return mData == x.mData;}
 			pointer			operator->	() const { return mData;  }
-			const_iterator	operator++	(int);
+			const_iterator	operator++	(int)	 { const_iterator prev(*this); ++mData; return prev; }
 
 			// bidirectional iterator requirements
-			const_iterator&	operator--	();
-			const_iterator	operator--	(int);
+			const_iterator&	operator--	()		 { --mData; return *this; }
+			const_iterator	operator--	(int)	 { const_iterator prev(*this); --mData; return prev; }
 
 			// Random access iterator requirements
-			const_iterator& operator+=	(difference_type n);
-			const_iterator& operator-=	(difference_type n);
-			const_iterator	operator+	(difference_type n);
-			const_iterator	operator-	(difference_type n);
+			const_iterator& operator+=	(difference_type n) { mData += n; return *this; }
+			const_iterator& operator-=	(difference_type n) { mData -= n; return *this; }
+			const_iterator	operator+	(difference_type n) const { return const_iterator(mData + n); }
+			const_iterator	operator-	(difference_type n) const { return const_iterator(mData - n); }
+			difference_type	operator-	(const const_iterator& x) const { return mData - x.mData; }
 
-			reference		operator[]	(difference_type n);
+			reference		operator[]	(difference_type n) const { return mData[n]; }
 
-			bool			operator<	(const const_iterator& );
+			bool			operator<	(const const_iterator& x) const { return mData < x.mData; }
 
 		protected:
 			T* mData;
@@ -149,52 +170,79 @@ namespace rtl
 			typedef T*	pointer;
 			typedef T&	reference;
 			typedef typename rtl::allocator_traits<allocatorT>::difference_type	difference_type;
-			typedef random_access_iterator_tag	iterator_category;
+			typedef contiguous_iterator_tag		iterator_category;
 			
 			// Construction, copy and destruction
 			iterator				()	// default constructor
-				: typename const_iterator(0) {}
+				: const_iterator(0) {}
 			iterator				(pointer x)
-				: typename const_iterator(x) {}
+				: const_iterator(x) {}
 			iterator				(const iterator& x)	// Copy constructor
-				: typename const_iterator(x) {}
+				: const_iterator(x) {}
 			iterator& operator=		(const iterator& x)	// Assignment operator
-			{	mData = x.mData; }
+			{	this->mData = x.mData; return *this; }
 			~iterator				() {}
 
 			// Basic iterator requirements
-			iterator&	operator++	() { ++mData; return *this; }
+			iterator&	operator++	() { ++this->mData; return *this; }
 			
 			// Input iterator requirements
-			iterator	operator++	(int) { ++mData; return *this; }
+			iterator	operator++	(int) { iterator prev(*this); ++this->mData; return prev; }
 			
 			// Output iterator requirements
-			reference	operator*	() const { return *mData; }
-			pointer		operator->	() const { return mData;  }
+			reference	operator*	() const { return *this->mData; }
+			pointer		operator->	() const { return this->mData;  }
 
 			// bidirectional iterator requirements
-			iterator&	operator--	() { --mData; return *this; }
-			iterator	operator--	(int) { +--Data; return *this; }
+			iterator&	operator--	() { --this->mData; return *this; }
+			iterator	operator--	(int) { iterator prev(*this); --this->mData; return prev; }
 
 			// Random access iterator requirements
-			iterator&	operator+=	(difference_type n);
-			iterator&	operator-=	(difference_type n);
-			iterator	operator+	(difference_type n);
-			iterator	operator-	(difference_type n);
+			iterator&	operator+=	(difference_type n) { this->mData += n; return *this; }
+			iterator&	operator-=	(difference_type n) { this->mData -= n; return *this; }
+			iterator	operator+	(difference_type n) const { return iterator(this->mData + n); }
+			iterator	operator-	(difference_type n) const { return iterator(this->mData - n); }
+			difference_type	operator-	(const const_iterator& x) const { return const_iterator::operator-(x); }
 
-			reference	operator[]	(difference_type n);
+			reference	operator[]	(difference_type n) const { return this->mData[n]; }
 
-			bool		operator<	(const iterator& );
+			bool		operator<	(const iterator& x) const { return this->mData < x.mData; }
 		};
 
 		private:
 			size_type	mSize;
-			size_type	mCapacity;
 			T*			mData;
-			allocatorT	mAlloc;
+			// The allocator shares storage with the capacity, so a stateless one takes no room
+			compressed_pair<allocatorT, size_type>	mAllocCapacity;
 
 	private:
 		void reallocate( size_type n );
+		size_type grownCapacity( size_type n ) const;	// Capacity to hold n more elements with geometric growth
+
+		// Range insertion, dispatched on integral arguments (which mean insert(position, n, x)) and on the category
+		template<class Integer>
+		iterator insertDispatch( const_iterator position, Integer n, Integer x, true_type );
+		template<class InputIterator>
+		iterator insertDispatch( const_iterator position, InputIterator first, InputIterator last, false_type );
+		template<class InputIterator>
+		iterator insertRange( const_iterator position, InputIterator first, InputIterator last, input_iterator_tag );
+		template<class ForwardIterator>
+		iterator insertRange( const_iterator position, ForwardIterator first, ForwardIterator last, forward_iterator_tag );
+
+		// Constructs the elements of [first, last) on the uninitialized memory at dst. Returns the end of the new elements.
+		template<class InputIterator>
+		T* constructRange( InputIterator first, InputIterator last, T* dst );
+		template<class InputIterator>
+		T* constructRange( InputIterator first, InputIterator last, T* dst, false_type );
+		template<class InputIterator>
+		T* constructRange( InputIterator first, InputIterator last, T* dst, true_type );	// Bitwise copy
+		// Moves [first, last) to the uninitialized memory at dst, destroying the originals
+		void relocate( T* first, T* last, T* dst );
+		// Rotates [first, last) so middle becomes the first element
+		static void rotate( T* first, T* middle, T* last );
+
+		allocatorT&			alloc	()			{ return mAllocCapacity.first(); }
+		const allocatorT&	alloc	() const	{ return mAllocCapacity.first(); }
 	};
 
 	// Specialized algorithms
@@ -208,9 +256,8 @@ namespace rtl
 	template<class T, class allocatorT>
 	vector<T,allocatorT>::vector(const allocatorT& _alloc)
 		:mSize(0)
-		,mCapacity(0)
 		,mData(0)
-		,mAlloc(_alloc)
+		,mAllocCapacity(_alloc, 0)
 	{
 	}
 
@@ -218,8 +265,8 @@ namespace rtl
 	template<class T, class allocatorT>
 	vector<T,allocatorT>::vector(typename vector<T,allocatorT>::size_type n)
 		:mSize(0)
-		,mCapacity(0)
 		,mData(0)
+		,mAllocCapacity(allocatorT(), 0)
 	{
 		resize(n);
 	}
@@ -227,40 +274,68 @@ namespace rtl
 	//-----------------------------------------------------------------------
 	template<class T, class allocatorT>
 	vector<T, allocatorT>::vector(typename vector<T,allocatorT>::size_type n,
-		const T& x, const allocatorT& alloc)
+		const T& x, const allocatorT& _alloc)
 		:mSize(0)
-		,mCapacity(0)
 		,mData(0)
-		,mAlloc(alloc)
+		,mAllocCapacity(_alloc, 0)
 	{
 		resize(n, x);
 	}
 
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT>
+	template<class InputIterator>
+	vector<T, allocatorT>::vector(InputIterator first, InputIterator last, const allocatorT& _alloc)
+		:mSize(0)
+		,mData(0)
+		,mAllocCapacity(_alloc, 0)
+	{
+		insertDispatch(end(), first, last, is_integral<InputIterator>());
+	}
+
 	//-----------------------------------------------------------------------
 	template<class T, class allocatorT>
 	vector<T, allocatorT>::vector(const vector<T,allocatorT>& _x)
 		:mSize(0)
-		,mCapacity(0)
 		,mData(0)
-		,mAlloc(_x.mAlloc)
+		,mAllocCapacity(_x.alloc(), 0)
 	{
 		reserve(_x.mSize);
-		for(unsigned i = 0; i < mCapacity; ++i)
-			push_back(_x[i]);
+		mSize = constructRange(_x.mData, _x.mData + _x.mSize, mData) - mData;
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT>
+	vector<T, allocatorT>::vector(vector<T,allocatorT>&& _x)
+		:mSize(_x.mSize)
+		,mData(_x.mData)
+		,mAllocCapacity(_x.mAllocCapacity)
+	{
+		_x.mSize = 0;
+		_x.mData = 0;
+		_x.mAllocCapacity.second() = 0;
 	}
 
 	//-----------------------------------------------------------------------
 	template<class T, class allocatorT>
 	vector<T,allocatorT>& vector<T,allocatorT>::operator=(const vector<T,allocatorT>& x)
 	{
+		if(this == &x)
+			return *this;
 		clear();	// Delete previous content
-		if(x.mSize > mCapacity)
+		if(x.mSize > capacity())
 			reallocate(x.mSize);
-		mSize = x.mSize;
-		for(size_type i = 0; i < mSize; ++i)
-		{
-			mAlloc.construct(&mData[i], x[i]);
-		}
+		mSize = constructRange(x.mData, x.mData + x.mSize, mData) - mData;
+		return *this;
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT>
+	vector<T,allocatorT>& vector<T,allocatorT>::operator=(vector<T,allocatorT>&& x)
+	{
+		// Take x's buffer and leave ours to x's destructor
+		swap(x);
+		x.clear();
 		return *this;
 	}
 
@@ -269,7 +344,7 @@ namespace rtl
 	vector<T, allocatorT>::~vector()
 	{
 		resize(0);
-		allocator_traits<allocatorT>::deallocate(mAlloc, mData, mCapacity);
+		allocator_traits<allocatorT>::deallocate(alloc(), mData, capacity());
 	}
 
 	//-----------------------------------------------------------------------
@@ -304,44 +379,52 @@ namespace rtl
 	template<class T, class allocatorT>
 	void vector<T, allocatorT>::resize(typename vector<T,allocatorT>::size_type n)
 	{
-		if(n > mCapacity)
+		if(n > capacity())
 		{
 			reallocate(n);
 		}
 		while(n > mSize)
-			mAlloc.construct(&mData[mSize++]);
+			alloc().construct(&mData[mSize++]);
 		while(n < mSize)
-			mAlloc.destroy(&mData[--mSize]);
+			alloc().destroy(&mData[--mSize]);
 	}
 
 	//-----------------------------------------------------------------------
 	template<class T, class allocatorT>
 	void vector<T, allocatorT>::resize(typename vector<T,allocatorT>::size_type n, const T& x)
 	{
-		if(n > mCapacity)
+		if(n > capacity())
 		{
 			reallocate(n);
 		}
 		while(n > mSize)
-			mAlloc.construct(&mData[mSize++], x);
+			alloc().construct(&mData[mSize++], x);
 		while(n < mSize)
-			mAlloc.destroy(&mData[--mSize]);
+			alloc().destroy(&mData[--mSize]);
 	}
 
 	//-----------------------------------------------------------------------
 	template<class T, class allocatorT>
 	void vector<T, allocatorT>::reallocate(size_type n)
 	{
-		T* temp_buffer = allocator_traits<allocatorT>::allocate(mAlloc, n);
-		for(size_type i = 0; i < n, i < mSize; ++i)
-		{
-			mAlloc.construct(&temp_buffer[i], mData[i]);
-		}
-		if(0 != mCapacity)
-			allocator_traits<allocatorT>::deallocate(mAlloc, mData, mCapacity);
+		RTL_PROFILE(vector_reallocate);
+		// Elements that don't fit are destroyed, the rest are moved to the new buffer
+		while(n < mSize)
+			alloc().destroy(&mData[--mSize]);
+		T* temp_buffer = allocator_traits<allocatorT>::allocate(alloc(), n);
+		relocate(mData, mData + mSize, temp_buffer);
+		if(0 != capacity())
+			allocator_traits<allocatorT>::deallocate(alloc(), mData, capacity());
 		mData = temp_buffer;
-		mCapacity = n;
-		mSize = n<mSize?n:mSize;
+		mAllocCapacity.second() = n;
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT>
+	typename vector<T, allocatorT>::size_type vector<T, allocatorT>::grownCapacity(size_type n) const
+	{
+		size_type grown = capacity() ? capacity() * 2 : 2;
+		return grown < mSize + n ? mSize + n : grown;
 	}
 
 	//-----------------------------------------------------------------------
@@ -355,21 +438,35 @@ namespace rtl
 	template<class T, class allocatorT>
 	void vector<T, allocatorT>::push_back(const T& x)
 	{
-		if(mSize == mCapacity)
+		if(mSize == capacity())
 		{
-			if(0 == mCapacity)
+			if(0 == capacity())
 				reallocate(2);
 			else
-				reallocate(mCapacity*2);
+				reallocate(capacity()*2);
 		}
-		mAlloc.construct(&mData[mSize++], x);
+		alloc().construct(&mData[mSize++], x);
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT>
+	void vector<T, allocatorT>::push_back(T&& x)
+	{
+		if(mSize == capacity())
+		{
+			if(0 == capacity())
+				reallocate(2);
+			else
+				reallocate(capacity()*2);
+		}
+		alloc().construct(&mData[mSize++], rtl::move(x));
 	}
 
 	//-----------------------------------------------------------------------
 	template<class T, class allocatorT>
 	void vector<T, allocatorT>::pop_back()
 	{
-		mAlloc.destroy(&mData[--mSize]);
+		alloc().destroy(&mData[--mSize]);
 	}
 
 	//-----------------------------------------------------------------------
@@ -382,10 +479,202 @@ namespace rtl
 			*aux = *(aux+1);
 			++aux;
 		}
-		mAlloc.destroy(&mData[--mSize]); // Destroy last element and decrease size
+		alloc().destroy(&mData[--mSize]); // Destroy last element and decrease size
 		return iterator(const_cast<T*>(&*x));
 	}
 
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT>
+	typename vector<T,allocatorT>::iterator vector<T, allocatorT>::insert(const_iterator position, const T& x)
+	{
+		return insert(position, 1, x);
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT>
+	typename vector<T,allocatorT>::iterator vector<T, allocatorT>::insert(const_iterator position, T&& x)
+	{
+		size_type offset = position - begin();
+		push_back(rtl::move(x));
+		rotate(mData + offset, mData + mSize - 1, mData + mSize);
+		return iterator(mData + offset);
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT>
+	typename vector<T,allocatorT>::iterator vector<T, allocatorT>::insert(const_iterator position, size_type n, const T& x)
+	{
+		size_type offset = position - begin();
+		T value(x);	// x may be one of our elements
+		reserve(mSize + n > capacity() ? grownCapacity(n) : 0);
+		for(size_type i = 0; i < n; ++i)
+			alloc().construct(&mData[mSize++], value);
+		rotate(mData + offset, mData + mSize - n, mData + mSize);
+		return iterator(mData + offset);
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT>
+	template<class InputIterator>
+	typename vector<T,allocatorT>::iterator vector<T, allocatorT>::insert(const_iterator position,
+		InputIterator first, InputIterator last)
+	{
+		return insertDispatch(position, first, last, is_integral<InputIterator>());
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT>
+	template<class Integer>
+	typename vector<T,allocatorT>::iterator vector<T, allocatorT>::insertDispatch(const_iterator position,
+		Integer n, Integer x, true_type)
+	{
+		return insert(position, size_type(n), T(x));
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT>
+	template<class InputIterator>
+	typename vector<T,allocatorT>::iterator vector<T, allocatorT>::insertDispatch(const_iterator position,
+		InputIterator first, InputIterator last, false_type)
+	{
+		return insertRange(position, first, last, typename iterator_traits<InputIterator>::iterator_category());
+	}
+
+	//-----------------------------------------------------------------------
+	// The size of single pass ranges is unknown. Append them one element at a time, then move them into place.
+	template<class T, class allocatorT>
+	template<class InputIterator>
+	typename vector<T,allocatorT>::iterator vector<T, allocatorT>::insertRange(const_iterator position,
+		InputIterator first, InputIterator last, input_iterator_tag)
+	{
+		size_type offset = position - begin();
+		size_type oldSize = mSize;
+		for(; first != last; ++first)
+			push_back(*first);
+		rotate(mData + offset, mData + oldSize, mData + mSize);
+		return iterator(mData + offset);
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT>
+	template<class ForwardIterator>
+	typename vector<T,allocatorT>::iterator vector<T, allocatorT>::insertRange(const_iterator position,
+		ForwardIterator first, ForwardIterator last, forward_iterator_tag)
+	{
+		size_type offset = position - begin();
+		size_type n = size_type(rtl::distance(first, last));
+		if(mSize + n > capacity())
+		{
+			// Build the result straight into a new buffer, so every element is transferred once
+			size_type newCapacity = grownCapacity(n);
+			T* buffer = allocator_traits<allocatorT>::allocate(alloc(), newCapacity);
+			constructRange(first, last, buffer + offset);
+			relocate(mData, mData + offset, buffer);
+			relocate(mData + offset, mData + mSize, buffer + offset + n);
+			if(0 != capacity())
+				allocator_traits<allocatorT>::deallocate(alloc(), mData, capacity());
+			mData = buffer;
+			mAllocCapacity.second() = newCapacity;
+		}
+		else if(is_trivially_copyable<T>::value)
+		{
+			// Open a gap for the new elements
+			memmove(static_cast<void*>(mData + offset + n), mData + offset, (mSize - offset) * sizeof(T));
+			constructRange(first, last, mData + offset);
+		}
+		else
+		{
+			constructRange(first, last, mData + mSize);
+			rotate(mData + offset, mData + mSize, mData + mSize + n);
+		}
+		mSize += n;
+		return iterator(mData + offset);
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT>
+	template<class InputIterator>
+	T* vector<T, allocatorT>::constructRange(InputIterator first, InputIterator last, T* dst)
+	{
+		typedef typename remove_const<typename iterator_traits<InputIterator>::value_type>::type sourceT;
+		return constructRange(first, last, dst, integral_constant<bool, is_trivially_copyable<T>::value
+			&& is_same<sourceT, T>::value && is_contiguous_iterator<InputIterator>::value>());
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT>
+	template<class InputIterator>
+	T* vector<T, allocatorT>::constructRange(InputIterator first, InputIterator last, T* dst, false_type)
+	{
+		for(; first != last; ++first, ++dst)
+			alloc().construct(dst, *first);
+		return dst;
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT>
+	template<class InputIterator>
+	T* vector<T, allocatorT>::constructRange(InputIterator first, InputIterator last, T* dst, true_type)
+	{
+		size_type n = size_type(last - first);
+		if(n)
+			memcpy(dst, &*rtl::unwrap_move(first), n * sizeof(T));
+		return dst + n;
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT>
+	void vector<T, allocatorT>::relocate(T* first, T* last, T* dst)
+	{
+		if(is_trivially_copyable<T>::value)
+		{
+			if(first != last)
+				memcpy(static_cast<void*>(dst), first, (last - first) * sizeof(T));
+			return;
+		}
+		for(; first != last; ++first, ++dst)
+		{
+			alloc().construct(dst, rtl::move(*first));
+			alloc().destroy(first);
+		}
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT>
+	void vector<T, allocatorT>::rotate(T* first, T* middle, T* last)
+	{
+		// Reverse both halves, then the whole range
+		for(T *a = first, *b = middle; a < b; )
+			rtl::swap(*a++, *--b);
+		for(T *a = middle, *b = last; a < b; )
+			rtl::swap(*a++, *--b);
+		for(T *a = first, *b = last; a < b; )
+			rtl::swap(*a++, *--b);
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT>
+	template<class Operation>
+	typename vector<T, allocatorT>::size_type vector<T, allocatorT>::append_uninitialized(size_type n, Operation op)
+	{
+		static_assert(is_trivially_copyable<T>::value, "append_uninitialized needs trivially copyable elements");
+		reserve(mSize + n);
+		size_type written = op(mData + mSize, n);
+		assert(written <= n);
+		mSize += written;
+		return written;
+	}
+
+	//-----------------------------------------------------------------------
+	template<class T, class allocatorT>
+	void vector<T, allocatorT>::swap(vector<T,allocatorT>& x)
+	{
+		rtl::swap(mSize, x.mSize);
+		rtl::swap(mData, x.mData);
+		rtl::swap(mAllocCapacity.first(), x.mAllocCapacity.first());
+		rtl::swap(mAllocCapacity.second(), x.mAllocCapacity.second());
+	}
+
 }	// namespace rtl
 
 #endif // _RTL_VECTOR_H_
\ No newline at end of file